@@ -0,0 +1,144 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.
+# The ASF licenses this file to You under the Apache License, Version 2.0
+# (the "License"); you may not use this file except in compliance with
+# the License.  You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+package ModPerl::PerlRunCached;
+
+use strict;
+use warnings FATAL => 'all';
+
+our $VERSION = '0.01';
+
+use base qw(ModPerl::PerlRun);
+
+# ModPerl::PerlRun recompiles the script and unloads its package on
+# every request, which gives each run a fresh set of package globals
+# but is very slow. This variant compiles the script once (recompiling
+# it when modified, like ModPerl::Registry), takes a snapshot of the
+# package's symbol table right after the compilation and after each
+# run restores the globals to that snapshot, instead of unloading the
+# package. Symbols created at run time are removed, and the subs are
+# restored if they were redefined.
+#
+# The snapshot is shallow: references stored in globals at compile
+# time (e.g. in BEGIN blocks) are restored, but not the data they
+# point to. And since the code isn't recompiled, named subs using the
+# script's file-scoped lexicals suffer from the same closure problem
+# as under ModPerl::Registry.
+
+sub handler : method {
+    my $class = (@_ >= 2) ? shift : __PACKAGE__;
+    my $r = shift;
+    return $class->new($r)->default_handler();
+}
+
+*is_cached      = \&ModPerl::RegistryCooker::is_cached;
+*should_compile = \&ModPerl::RegistryCooker::should_compile_if_modified;
+
+sub cache_it {
+    my $self = shift;
+    $self->ModPerl::RegistryCooker::cache_it();
+    $self->cache_table->{ $self->{PACKAGE} }{snapshot} =
+        $self->snapshot_namespace;
+}
+
+sub flush_namespace {
+    my $self = shift;
+
+    my $entry = $self->cache_table->{ $self->{PACKAGE} };
+    if ($entry && $entry->{snapshot}) {
+        $self->reset_namespace($entry->{snapshot});
+    }
+    else {
+        $self->flush_namespace_normal;
+    }
+}
+
+# return { symbol => { SCALAR => $value, ARRAY => [...],
+#                      HASH => {...}, CODE => \&code } }
+# for all the symbols in the script's package, excluding sub-packages
+sub snapshot_namespace {
+    my $self = shift;
+
+    my $stash = do { no strict 'refs'; \%{"$self->{PACKAGE}\::"} };
+
+    my %snapshot;
+    while (my ($name, $glob) = each %$stash) {
+        next if $name =~ /::$/;
+
+        # constant subs and sub declarations without a body may be
+        # stored as plain references/strings instead of globs, they
+        # have no slots to save but must survive reset_namespace()
+        unless (ref \$glob eq 'GLOB') {
+            $snapshot{$name} = {};
+            next;
+        }
+
+        my %slots = (SCALAR => ${ *{$glob}{SCALAR} });
+        if (my $av = *{$glob}{ARRAY}) {
+            $slots{ARRAY} = [@$av];
+        }
+        if (my $hv = *{$glob}{HASH}) {
+            $slots{HASH} = {%$hv};
+        }
+        if (my $cv = *{$glob}{CODE}) {
+            $slots{CODE} = $cv;
+        }
+        $snapshot{$name} = \%slots;
+    }
+
+    return \%snapshot;
+}
+
+# restore the globals of the script's package to $snapshot and delete
+# the symbols which didn't exist when it was taken
+sub reset_namespace {
+    my ($self, $snapshot) = @_;
+
+    my $stash = do { no strict 'refs'; \%{"$self->{PACKAGE}\::"} };
+
+    for my $name (keys %$stash) {
+        next if $name =~ /::$/;
+
+        my $slots = $snapshot->{$name};
+        unless ($slots) {
+            delete $stash->{$name};
+            next;
+        }
+
+        # left alone, see snapshot_namespace()
+        my $glob = $stash->{$name};
+        next unless ref \$glob eq 'GLOB';
+
+        my $sv = *{$glob}{SCALAR};
+        $$sv = $slots->{SCALAR} unless Internals::SvREADONLY($$sv);
+
+        if (my $av = *{$glob}{ARRAY}) {
+            @$av = $slots->{ARRAY} ? @{ $slots->{ARRAY} } : ();
+        }
+        if (my $hv = *{$glob}{HASH}) {
+            %$hv = $slots->{HASH} ? %{ $slots->{HASH} } : ();
+        }
+
+        my $cv = *{$glob}{CODE};
+        if ($slots->{CODE} && (!$cv || $cv != $slots->{CODE})) {
+            no warnings 'redefine';
+            *{$glob} = $slots->{CODE};
+        }
+    }
+}
+
+1;
+__END__
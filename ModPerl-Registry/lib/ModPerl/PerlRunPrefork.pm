@@ -8,10 +8,15 @@ our $VERSION = '0.01';
 
 use base qw(ModPerl::PerlRun);
 
+# under threaded MPMs a real chdir() would affect all the threads, so
+# the virtual cwd is used instead (see chdir_file_virtual in
+# ModPerl::RegistryCooker), whose file ops are only installed when
+# this module is loaded
+my $threaded = 0;
 if ($ENV{MOD_PERL}) {
     require Apache2::MPM;
-    die "This package can't be used under threaded MPMs"
-        if Apache2::MPM->is_threaded;
+    $threaded = Apache2::MPM->is_threaded;
+    ModPerl::Util::enable_virtual_cwd() if $threaded;
 }
 
 sub handler : method {
@@ -20,7 +25,9 @@ sub handler : method {
     return $class->new($r)->default_handler();
 }
 
-*chdir_file = \&ModPerl::RegistryCooker::chdir_file_normal;
+*chdir_file = $threaded
+    ? \&ModPerl::RegistryCooker::chdir_file_virtual
+    : \&ModPerl::RegistryCooker::chdir_file_normal;
 
 1;
 __END__
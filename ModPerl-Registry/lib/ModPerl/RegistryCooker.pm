@@ -45,6 +45,7 @@ use ModPerl::Global ();
 
 use File::Spec::Functions ();
 use File::Basename ();
+use Time::HiRes ();
 
 use Apache2::Const -compile => qw(:common &OPT_EXECCGI);
 use APR::Const -compile => qw(FILETYPE_REG);
@@ -163,8 +164,13 @@ sub default_handler {
     if ($self->should_compile) {
         my $rc = $self->can_compile;
         return $rc unless $rc == Apache2::Const::OK;
+        my $start = Time::HiRes::time();
         $rc = $self->convert_script_to_compiled_handler;
         return $rc unless $rc == Apache2::Const::OK;
+        $self->cache_compiled(Time::HiRes::time() - $start);
+    }
+    else {
+        $self->cache_hit;
     }
 
     # handlers shouldn't set $r->status but return it, so we reset the
@@ -191,6 +197,9 @@ sub run {
     my $r       = $self->{REQ};
     my $package = $self->{PACKAGE};
 
+    # see chdir_file_virtual
+    local $ModPerl::Util::VirtualCwd = $ModPerl::Util::VirtualCwd;
+
     $self->chdir_file;
 
     my $cv = \&{"$package\::handler"};
@@ -371,15 +380,15 @@ sub convert_script_to_compiled_handler {
 
     $self->debug("Adding package $self->{PACKAGE}") if DEBUG & D_NOISE;
 
-    # get the script's source
-    $rc = $self->read_script;
+    # get the script's source, with the shebang line opts converted
+    # into perl code and the __END__/__DATA__ segment stripped
+    ($rc, my $shebang) = $self->read_transformed_script;
     return $rc unless $rc == Apache2::Const::OK;
 
-    # convert the shebang line opts into perl code
-    my $shebang = $self->shebang_to_perl;
-
     # mod_cgi compat, should compile the code while in its dir, so
-    # relative require/open will work.
+    # relative require/open will work. the virtual cwd is restored on
+    # return, even if the compilation fails
+    local $ModPerl::Util::VirtualCwd = $ModPerl::Util::VirtualCwd;
     $self->chdir_file;
 
 #    undef &{"$self->{PACKAGE}\::handler"}; unless DEBUG & D_NOISE; #avoid warnings
@@ -387,8 +396,6 @@ sub convert_script_to_compiled_handler {
 
     my $line = $self->get_mark_line;
 
-    $self->strip_end_data_segment;
-
     # handle the non-parsed handlers ala mod_cgi (though mod_cgi does
     # some tricks removing the header_out and other filters, here we
     # just call assbackwards which has the same effect).
@@ -454,10 +461,157 @@ sub cache_table_local {
 
 sub cache_it {
     my $self = shift;
-    $self->cache_table->{ $self->{PACKAGE} }{mtime} = $self->{MTIME};
+    my $entry = $self->cache_table->{ $self->{PACKAGE} };
+    $entry->{mtime}   = $self->{MTIME};
+    $entry->{checked} = time;
 }
 
 
+#########################################################################
+# func: cache_hit
+# dflt: cache_hit
+# desc: account a request served by the cached package
+# args: $self - registry blessed object
+# rtrn: nothing
+#########################################################################
+
+sub cache_hit {
+    my $self = shift;
+    my $entry = $self->cache_table->{ $self->{PACKAGE} } or return;
+    $entry->{hits}++;
+    # sub-second, or the scripts used within the same second would be
+    # evicted in no particular order
+    $entry->{atime} = Time::HiRes::time();
+}
+
+#########################################################################
+# func: cache_compiled
+# dflt: cache_compiled
+# desc: account the compilation of the package and evict the least
+#       recently used packages if the cache is over its limits
+# args: $self - registry blessed object
+#       $elapsed - the compilation time in seconds
+# rtrn: nothing
+# note: the cache limits are set with:
+#         PerlSetVar RegistryCacheMaxScripts 500
+#         PerlSetVar RegistryCacheMaxSize    100000000
+#       the cache is shared by all the locations, so each set of
+#       limits has its own LRU list: the scripts compiled in
+#       locations with the same limits are counted together, and
+#       never evict the scripts compiled under other limits (or
+#       none).
+#       the size is an estimate of the memory used by the compiled
+#       packages in bytes: their Devel::Size::total_size() if
+#       Devel::Size is available, ten times their source's length
+#       otherwise. it's only computed if RegistryCacheMaxSize is set
+#########################################################################
+
+sub cache_compiled {
+    my ($self, $elapsed) = @_;
+
+    # e.g. ModPerl::PerlRun doesn't cache
+    return unless $self->is_cached;
+
+    my ($max_scripts, $max_size) = $self->cache_limits;
+
+    my $entry = $self->cache_table->{ $self->{PACKAGE} };
+    $entry->{compiles}++;
+    $entry->{compile_time} += $elapsed;
+    $entry->{atime} = Time::HiRes::time();
+    if ($max_scripts || $max_size) {
+        $entry->{limits} = "$max_scripts:$max_size";
+    }
+    else {
+        delete $entry->{limits};
+    }
+    if ($max_size) {
+        $entry->{size} = $self->package_size;
+    }
+    else {
+        delete $entry->{size};
+    }
+
+    $self->cache_evict;
+}
+
+# the RegistryCacheMaxScripts and RegistryCacheMaxSize limits of the
+# current location, 0 if not set
+sub cache_limits {
+    my $self = shift;
+    my $r = $self->{REQ};
+
+    return (($r->dir_config('RegistryCacheMaxScripts') || 0) + 0,
+            ($r->dir_config('RegistryCacheMaxSize')    || 0) + 0);
+}
+
+# estimate the memory used by the compiled package
+sub package_size {
+    my $self = shift;
+
+    if (eval { require Devel::Size; 1 }) {
+        no strict 'refs';
+        my $size = eval {
+            local $Devel::Size::warn = 0;
+            Devel::Size::total_size(\%{"$self->{PACKAGE}\::"});
+        };
+        return $size if $size;
+    }
+
+    return $self->{CODE} ? 10 * length ${ $self->{CODE} } : 0;
+}
+
+#########################################################################
+# func: cache_evict
+# dflt: cache_evict
+# desc: unload the least recently used packages until the cache is
+#       within the RegistryCacheMaxScripts/RegistryCacheMaxSize limits,
+#       considering only the packages compiled under the same limits
+# args: $self - registry blessed object
+# rtrn: nothing
+# note: the evicted entries keep their stats, but not the mtime, so
+#       they are recompiled on the next request
+#########################################################################
+
+sub cache_evict {
+    my $self = shift;
+
+    my ($max_scripts, $max_size) = $self->cache_limits;
+    return unless $max_scripts || $max_size;
+
+    my $limits = "$max_scripts:$max_size";
+    my $table = $self->cache_table;
+    my @cached = grep { exists $table->{$_}{mtime} &&
+                        ($table->{$_}{limits} || '') eq $limits }
+        keys %$table;
+
+    my $size = 0;
+    $size += $table->{$_}{size} || 0 for @cached;
+
+    my $count = @cached;
+    return unless ($max_scripts && $count > $max_scripts) ||
+                  ($max_size && $size > $max_size);
+
+    my $package = $self->{PACKAGE};
+    for my $victim (sort { ($table->{$a}{atime} || 0) <=>
+                           ($table->{$b}{atime} || 0) } @cached) {
+        last unless ($max_scripts && $count > $max_scripts) ||
+                    ($max_size && $size > $max_size);
+        # never evict the package we are about to run
+        next if $victim eq $package;
+
+        my $entry = $table->{$victim};
+        $self->debug("evicting $victim") if DEBUG & D_NOISE;
+        {
+            local $self->{PACKAGE} = $victim;
+            $self->flush_namespace_normal;
+        }
+        delete $entry->{mtime};
+        $entry->{evictions}++;
+        $count--;
+        $size -= delete $entry->{size} || 0;
+    }
+}
+
 #########################################################################
 # func: is_cached
 # dflt: is_cached
@@ -486,12 +640,86 @@ sub is_cached {
 *should_compile = \&should_compile_once;
 
 # return false only if the package is cached and its source file
-# wasn't modified
+# wasn't modified.
+#
+# by default the script's mtime is checked on every request, which
+# can be relaxed with:
+#
+#   PerlSetVar RegistryCheckInterval 60
+#
+# to check it at most once every 60 seconds, or with:
+#
+#   PerlSetVar RegistryInotify On
+#
+# to check it only once and then rely on a Linux::Inotify2 watch to
+# mark the script as not cached when it changes (falls back to the
+# interval/every request check if Linux::Inotify2 is not available).
+# with either policy a cached script doesn't use $r->finfo at all, so
+# a PerlMapToStorageHandler returning Apache2::Const::OK can be used
+# to skip the core's directory walk and the stat(2) calls it does
 sub should_compile_if_modified {
     my $self = shift;
-    $self->{MTIME} ||= $self->{REQ}->finfo->mtime;
-    !($self->is_cached &&
-      $self->cache_table->{ $self->{PACKAGE} }{mtime} == $self->{MTIME});
+
+    return TRUE unless $self->is_cached;
+
+    my $r = $self->{REQ};
+    my $entry = $self->cache_table->{ $self->{PACKAGE} };
+
+    if ($entry->{watched} && $entry->{watched} == $$) {
+        # the watch callback drops the entry's mtime
+        inotify()->poll;
+        return !$self->is_cached;
+    }
+
+    my $interval = $r->dir_config('RegistryCheckInterval');
+    return FALSE if $interval && time - ($entry->{checked} || 0) < $interval;
+
+    $self->{MTIME} ||= $r->finfo->mtime;
+    return TRUE unless $entry->{mtime} == $self->{MTIME};
+
+    $entry->{checked} = time;
+    if (($r->dir_config('RegistryInotify') || '') =~ /^on$/i) {
+        $entry->{watched} = $self->watch_script ? $$ : 0;
+    }
+
+    return FALSE;
+}
+
+# the per-process Linux::Inotify2 object used by the RegistryInotify
+# policy, or 0 if it's not available. it's created lazily at request
+# time, so each child (and each interpreter) gets its own descriptor
+my %inotify;
+sub inotify {
+    return $inotify{$$} if exists $inotify{$$};
+    %inotify = ();
+    my $inotify = eval { require Linux::Inotify2; Linux::Inotify2->new } || 0;
+    $inotify->blocking(0) if $inotify;
+    return $inotify{$$} = $inotify;
+}
+
+# add an inotify watch invalidating the script's cache entry when the
+# file is modified, replaced or removed (only the mtime and the check
+# state go, the stats are kept as with cache_evict). returns TRUE on success. the
+# watch belongs to the current process, so the entry remembers the
+# pid it was added in
+sub watch_script {
+    my $self = shift;
+
+    my $inotify = inotify() or return FALSE;
+
+    my ($table, $package) = ($self->cache_table, $self->{PACKAGE});
+    my $mask = Linux::Inotify2::IN_MODIFY() | Linux::Inotify2::IN_ATTRIB() |
+        Linux::Inotify2::IN_MOVE_SELF() | Linux::Inotify2::IN_DELETE_SELF();
+
+    my $watch = $inotify->watch($self->{FILENAME}, $mask, sub {
+        my $event = shift;
+        if (my $entry = $table->{$package}) {
+            delete @$entry{qw(mtime checked watched)};
+        }
+        $event->w->cancel;
+    });
+
+    return $watch ? TRUE : FALSE;
 }
 
 # return false if the package is cached already
@@ -557,6 +785,157 @@ sub read_script {
     return Apache2::Const::OK;
 }
 
+#########################################################################
+# func: read_transformed_script
+# dflt: read_transformed_script
+# desc: reads the script in, converts the shebang line and strips the
+#       __END__/__DATA__ segment, unless the result is found in the
+#       source cache
+# args: $self - registry blessed object
+# rtrn: (Apache2::Const::OK on success or some other code on failure,
+#        the perl code generated from the shebang line)
+# efct: initializes the CODE field with the transformed source
+# note: the source cache is enabled with:
+#         PerlSetVar RegistrySourceCache On
+#       it's keyed by the class and the file's device, inode, mtime
+#       and size, so a modified script is never served from it. it's
+#       kept per interpreter, so when the scripts are preloaded with
+#       ModPerl::RegistryLoader it's inherited by all the clones and
+#       children. with:
+#         PerlSetVar RegistrySourceCacheDir /some/dir
+#       the transformed sources are also stored as files in that
+#       directory, so they are shared by all the processes, including
+#       the children started after the old ones were recycled. the
+#       directory is created with mode 0700 if it doesn't exist, and
+#       ignored unless it belongs to the server user and is neither
+#       group nor world writable
+#########################################################################
+
+my %source_cache;      # key => [$shebang, $code]
+my %source_cache_key;  # filename => key
+
+sub read_transformed_script {
+    my $self = shift;
+    my $r = $self->{REQ};
+
+    my $dir = $r->dir_config('RegistrySourceCacheDir');
+    $dir = undef if $dir && !$self->source_cache_dir_ok($dir);
+    my $key;
+    if ($dir || ($r->dir_config('RegistrySourceCache') || '') =~ /^on$/i) {
+        $key = $self->source_cache_key;
+        if (my $cached = $source_cache{$key}
+                || ($dir && $self->source_cache_load($dir, $key))) {
+            $self->debug("source cache hit: $key") if DEBUG & D_NOISE;
+            my ($shebang, $code) = @$cached;
+            $self->{CODE} = \$code;
+            $source_cache{$key} = $cached;
+            return (Apache2::Const::OK, $shebang);
+        }
+    }
+
+    my $rc = $self->read_script;
+    return ($rc, "") unless $rc == Apache2::Const::OK;
+
+    my $shebang = $self->shebang_to_perl;
+    $self->strip_end_data_segment;
+
+    if ($key) {
+        my $old = $source_cache_key{ $self->{FILENAME} };
+        delete $source_cache{$old} if $old && $old ne $key;
+        $source_cache_key{ $self->{FILENAME} } = $key;
+        $source_cache{$key} = [$shebang, ${ $self->{CODE} }];
+        $self->source_cache_store($dir, $key, $shebang) if $dir;
+    }
+
+    return (Apache2::Const::OK, $shebang);
+}
+
+# the class, which may transform the source its own way, and the
+# identity of the script's file: device, inode, mtime and size (plus
+# the file name where there are no inodes)
+sub source_cache_key {
+    my $self = shift;
+    my $finfo = $self->{REQ}->finfo;
+    my $key = join '-', ref $self, $finfo->device, $finfo->inode,
+        $finfo->mtime, $finfo->size;
+    $key .= "-$self->{FILENAME}" unless $finfo->inode;
+    return $key;
+}
+
+# the cached sources get compiled, so nobody but the server may be
+# able to write them
+sub source_cache_dir_ok {
+    my ($self, $dir) = @_;
+
+    mkdir $dir, 0700 unless -e $dir;
+
+    my @stat = lstat $dir;
+    my $why;
+    if (!@stat) {
+        $why = "can't stat it: $!";
+    }
+    elsif (!-d _) {
+        $why = "not a directory";
+    }
+    elsif ($stat[4] != $>) {
+        $why = "not owned by uid $>";
+    }
+    elsif ($stat[2] & 022) {
+        $why = "group or world writable";
+    }
+    else {
+        return 1;
+    }
+
+    $self->{REQ}->log_error("RegistrySourceCacheDir $dir ignored: $why");
+    return 0;
+}
+
+sub source_cache_file {
+    my ($dir, $key) = @_;
+    $key =~ s/([^A-Za-z0-9_-])/sprintf("_%2x", unpack("C", $1))/eg;
+    File::Spec::Functions::catfile($dir, $key);
+}
+
+# the file format is: "length of the shebang code\n", the shebang
+# code and the transformed source
+sub source_cache_load {
+    my ($self, $dir, $key) = @_;
+
+    my $file = source_cache_file($dir, $key);
+    open my $fh, '<', $file or return;
+    binmode $fh;
+    my $data = do { local $/; <$fh> };
+    close $fh;
+
+    # the cache directory is trusted
+    my ($len, $rest) = $data =~ /^(\d+)\n(.*)\z/s or return;
+    return if $len > length $rest;
+
+    return [substr($rest, 0, $len), substr($rest, $len)];
+}
+
+sub source_cache_store {
+    my ($self, $dir, $key, $shebang) = @_;
+
+    my $file = source_cache_file($dir, $key);
+    my $tmp  = "$file.$$." . int rand 100_000;
+
+    my $ok = open my $fh, '>', $tmp;
+    if ($ok) {
+        binmode $fh;
+        $ok = print $fh length($shebang), "\n", $shebang, ${ $self->{CODE} };
+        $ok = close($fh) && $ok;
+        # rename is atomic, readers see either no file or a complete one
+        $ok &&= rename $tmp, $file;
+    }
+
+    unless ($ok) {
+        $self->{REQ}->log_error("can't store $file in the source cache: $!");
+        unlink $tmp;
+    }
+}
+
 #########################################################################
 # func: shebang_to_perl
 # dflt: shebang_to_perl
@@ -627,6 +1006,22 @@ sub chdir_file_normal {
     chdir $dir or die "Can't chdir to $dir: $!";
 }
 
+# a thread-safe alternative to chdir_file_normal: instead of changing
+# the process' cwd, sets the interpreter's virtual cwd, against which
+# mod_perl resolves relative file names passed to open, sysopen,
+# opendir, stat, the file tests and ./ names passed to require and
+# do (the caller must have called ModPerl::Util::enable_virtual_cwd()
+# before the code using them was compiled). run() and
+# convert_script_to_compiled_handler() local-ize it, so it never
+# outlives them. external programs (system, qx//) and an explicit
+# chdir() in the script still see the real cwd
+sub chdir_file_virtual {
+    my ($self, $dir) = @_;
+    $dir ||= File::Basename::dirname($self->{FILENAME});
+    $self->debug("virtual chdir $dir") if DEBUG & D_NOISE;
+    $ModPerl::Util::VirtualCwd = $dir;
+}
+
 #########################################################################
 # func: get_mark_line
 # dflt: get_mark_line
@@ -28,6 +28,8 @@ use APR::Const -compile=>qw(FINFO_MIN);
 
 use Carp;
 use File::Spec ();
+use DirHandle ();
+use Time::HiRes ();
 
 use Apache2::Const -compile => qw(OK HTTP_OK OPT_EXECCGI);
 
@@ -91,9 +93,10 @@ sub handler {
     }
 
     my $rl = bless {
-        uri      => $uri,
-        filename => $filename,
-        package  => $self->{package},
+        uri        => $uri,
+        filename   => $filename,
+        package    => $self->{package},
+        dir_config => $self->{dir_config},
     } => ref($self) || $self;
 
     $rl->{virthost} = $virthost if defined $virthost;
@@ -107,6 +110,128 @@ sub handler {
 
 }
 
+# compile all the scripts found under $dir (recursively, unless
+# recurse => 0 is passed) mapping each of them to the uri
+# $base_uri/relative/path. Meant to be called from a startup file, so
+# the scripts are compiled once in the parent interpreter and shared
+# by all the clones/children instead of being compiled on the first
+# request in each of them. Only the files matching the 'match' regex
+# (.pl and .cgi by default) are loaded. If 'report' is passed, the
+# per-script compilation time and memory growth is written to that
+# file. Returns the number of successfully compiled scripts.
+sub load_dir {
+    my ($self, $base_uri, $dir, %args) = @_;
+
+    unless (defined $base_uri && defined $dir) {
+        $self->warn("base uri and directory are required arguments");
+        return 0;
+    }
+
+    my $match   = $args{match} || qr/\.(?:pl|cgi)$/;
+    my $recurse = exists $args{recurse} ? $args{recurse} : 1;
+
+    $base_uri =~ s|/+$||;
+
+    my $loaded = 0;
+    my @dirs = ('');
+    while (defined(my $rel = shift @dirs)) {
+        my $path = length $rel ? File::Spec->catdir($dir, $rel) : $dir;
+        my $dh = DirHandle->new($path);
+        unless ($dh) {
+            $self->warn("Cannot read directory $path: $!");
+            next;
+        }
+
+        for my $entry (sort $dh->read) {
+            next if $entry =~ /^\./;
+            my $rel_entry = length $rel ? "$rel/$entry" : $entry;
+            my $file = File::Spec->catfile($path, $entry);
+            if (-d $file) {
+                push @dirs, $rel_entry if $recurse;
+                next;
+            }
+            next unless -f _ && $entry =~ $match;
+            $loaded++ if $self->load_file("$base_uri/$rel_entry", $file);
+        }
+    }
+
+    $self->write_report($args{report}) if $args{report};
+
+    return $loaded;
+}
+
+# compile a single script via handler(), recording how long it took
+# and how much the process has grown. a script that fails to compile
+# is logged and skipped, so one bad script doesn't abort the whole
+# directory crawl
+sub load_file {
+    my ($self, $uri, $filename, $virthost) = @_;
+
+    my $size  = proc_mem_size();
+    my $start = Time::HiRes::time();
+    my $rc = eval { $self->handler($uri, $filename, $virthost) };
+    my $elapsed = Time::HiRes::time() - $start;
+    $self->warn("failed to compile $filename: $@") if $@;
+
+    my $entry = {
+        uri      => $uri,
+        filename => $filename,
+        ok       => (!$@ && defined $rc && $rc == Apache2::Const::OK) ? 1 : 0,
+        seconds  => $elapsed,
+        bytes    => proc_mem_size() - $size,
+    };
+    push @{ $self->{report} }, $entry;
+
+    if ($self->{debug}) {
+        $self->warn(sprintf "%s %s in %.3f secs, %d bytes", $uri,
+                    ($entry->{ok} ? "compiled" : "failed"),
+                    $entry->{seconds}, $entry->{bytes});
+    }
+
+    return $entry->{ok};
+}
+
+# the list of { uri, filename, ok, seconds, bytes } entries for all
+# the scripts loaded via load_dir() and load_file() so far
+sub report { @{ shift->{report} || [] } }
+
+# dump the report into $file, slowest scripts first
+sub write_report {
+    my ($self, $file) = @_;
+
+    open my $fh, '>', $file or do {
+        $self->warn("Cannot open $file: $!");
+        return;
+    };
+
+    print $fh join("\t", qw(uri filename status seconds bytes)), "\n";
+    for my $e (sort { $b->{seconds} <=> $a->{seconds} } $self->report) {
+        printf $fh "%s\t%s\t%s\t%.6f\t%d\n", $e->{uri}, $e->{filename},
+            ($e->{ok} ? "ok" : "failed"), $e->{seconds}, $e->{bytes};
+    }
+
+    close $fh;
+}
+
+# the current process size in bytes, using GTop if it's available and
+# /proc otherwise. returns 0 if neither can be used
+my $page_size;
+sub proc_mem_size {
+    if (eval { require GTop; 1 }) {
+        return GTop->new->proc_mem($$)->size;
+    }
+
+    if (open my $fh, "/proc/$$/statm") {
+        my ($pages) = split ' ', scalar <$fh>;
+        close $fh;
+        $page_size ||= eval { require POSIX; POSIX::sysconf(POSIX::_SC_PAGESIZE()) }
+            || 4096;
+        return $pages * $page_size;
+    }
+
+    return 0;
+}
+
 # XXX: s/my_// for qw(my_finfo my_slurp_filename);
 # when when finfo() and slurp_filename() are ported to 2.0 and
 # RegistryCooker is starting to use them
@@ -120,6 +245,13 @@ sub finfo    { $_[0]->{finfo}||=APR::Finfo::stat($_[0]->{filename},
                                                  $_[0]->pool); }
 sub uri      { shift->{uri} }
 sub path_info {}
+# the loader has no per-dir config, but the dir_config => { ... }
+# option can provide the PerlSetVar values the registry package uses
+# (e.g. RegistrySourceCache)
+sub dir_config {
+    my ($self, $key) = @_;
+    return $self->{dir_config} ? $self->{dir_config}{$key} : undef;
+}
 sub allow_options { Apache2::Const::OPT_EXECCGI } #will be checked again at run-time
 sub log_error { shift; die @_ if $@; warn @_; }
 sub run { return Apache2::Const::OK } # don't run the script
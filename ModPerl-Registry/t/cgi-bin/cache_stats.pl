@@ -0,0 +1,10 @@
+#!perl -w
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+
+# prints how many times this script was compiled, from its
+# %ModPerl::RegistryCache entry
+
+print "Content-type: text/plain\n\n";
+
+my $entry = $ModPerl::RegistryCache{+__PACKAGE__} || {};
+print $entry->{compiles} || 0;
@@ -0,0 +1,23 @@
+#!perl -w
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+
+# test that ModPerl::PerlRunCached compiles the script once, but
+# resets its globals before every run
+
+use strict;
+
+our ($counter, @list, %hash);
+
+# an external package persists across requests
+BEGIN { $MyData::compiled{perlrun_cached}++ }
+
+$counter++;
+push @list, $counter;
+$hash{$counter}++;
+
+no strict 'refs';
+${"runtime_created"}++;
+
+print "Content-type: text/plain\n\n";
+print join ",", $MyData::compiled{perlrun_cached}, $counter, scalar(@list),
+    scalar(keys %hash), ${"runtime_created"};
@@ -0,0 +1,14 @@
+#!perl -w
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+
+# test that ModPerl::PerlRunCached keeps the script's constant subs
+# and sub declarations, which aren't globs in the stash, across runs
+
+use strict;
+
+use constant FOO => 42;
+sub bar;
+
+print "Content-type: text/plain\n\n";
+print join ",", FOO, __PACKAGE__->FOO, (__PACKAGE__->can('FOO') ? 1 : 0),
+    (exists &bar ? 1 : 0);
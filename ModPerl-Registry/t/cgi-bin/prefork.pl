@@ -9,7 +9,7 @@
 print "Content-type: text/plain\n\n";
 
 my $script = "prefork.pl";
-if (open my $fh, $script) {
+if (-e $script && open my $fh, $script) {
     print "ok $script";
 }
 else {
@@ -0,0 +1,13 @@
+#!perl -w
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+
+# this script is compiled at server startup by
+# ModPerl::RegistryLoader->load_dir (see modperl_extra_startup.pl), so
+# the pid seen at compile time is the one of the parent process
+
+our $compiled_by;
+BEGIN { $compiled_by = $$ }
+
+print "Content-type: text/plain\n\n";
+
+print $compiled_by == $$ ? "compiled on request" : "precompiled";
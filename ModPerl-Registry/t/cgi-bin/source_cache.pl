@@ -0,0 +1,13 @@
+#!perl -w
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+
+# the transformed source of this script is stored in the source cache
+# (see source_cache.t)
+
+print "Content-type: text/plain\n\n";
+
+print "ok source cache";
+
+__END__
+
+this data is stripped before the source is cached
@@ -18,7 +18,7 @@ use File::Spec::Functions;
 
 my @modules = qw(registry registry_bb perlrun);
 
-plan tests => 6, need [qw(mod_alias.c HTML::HeadParser)];
+plan tests => 8, need [qw(mod_alias.c HTML::HeadParser)];
 
 my $cfg = Apache::Test::config();
 
@@ -131,6 +131,38 @@ my $orig_mtime = (stat($path))[8];
     reset_mtime($path);
 }
 
+{
+    # ModPerl::Registry with RegistryCheckInterval
+    # no flush
+    # cache, check for mods at most once an hour
+    my $url = "/same_interp/registry_interval/$file";
+    my $same_interp = Apache::TestRequest::same_interp_tie($url);
+
+    my $first  = same_interp_req_body($same_interp, \&GET, $url);
+    my $second = same_interp_req_body($same_interp, \&GET, $url);
+    same_interp_skip_not_found(
+        (scalar(grep defined, $first, $second) != 2),
+        $first && $second && ($second - $first),
+        1,
+        "the closure problem should exist",
+    );
+
+    # modify the file
+    touch_mtime($path);
+
+    # the mtime was checked less than an hour ago, so the
+    # modification shouldn't be noticed
+    my $third = same_interp_req_body($same_interp, \&GET, $url);
+    same_interp_skip_not_found(
+        (scalar(grep defined, $first, $second, $third) != 3),
+        $first && $second && $third - $second,
+        1,
+        "no mtime check within the interval, the closure problem persists",
+    );
+
+    reset_mtime($path);
+}
+
 sub touch_mtime {
     my $file = shift;
     # push the mtime into the future (at least 2 secs to work on win32)
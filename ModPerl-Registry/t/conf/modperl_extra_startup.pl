@@ -50,4 +50,13 @@ for my $file (qw(basic.pl env.pl)) {
     }
 }
 
+# test the scripts pre-loading by crawling a directory
+{
+    my $rl = ModPerl::RegistryLoader->new(package => "ModPerl::Registry");
+    my $report = Apache2::ServerUtil::server_root_relative($pool,
+                     "logs/registry_preload.txt");
+    $rl->load_dir("/registry/preload", "$base_dir/preload",
+                  report => $report);
+}
+
 1;
@@ -0,0 +1,49 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+use Apache::TestRequest qw(GET);
+use TestCommon::SameInterp;
+
+plan tests => 5, need [qw(mod_alias.c HTML::HeadParser)];
+
+my $url = "/same_interp/perlrun_cached/perlrun_cached.pl";
+my $same_interp = Apache::TestRequest::same_interp_tie($url);
+
+my @compiled;
+for (1..2) {
+    my $res = same_interp_req_body($same_interp, \&GET, $url);
+    my ($compiled, @globals) = defined $res ? split /,/, $res : ();
+    push @compiled, $compiled;
+
+    # the globals are reset after each run
+    same_interp_skip_not_found(
+        !defined($res),
+        join(",", @globals),
+        "1,1,1,1",
+        "fresh globals on every run",
+    );
+}
+
+# but the script is compiled only once
+same_interp_skip_not_found(
+    (scalar(grep defined, @compiled) != 2),
+    $compiled[0] && $compiled[1] && ($compiled[1] - $compiled[0]),
+    0,
+    "the script is not recompiled",
+);
+
+# constant subs and sub declarations survive the reset
+$url = "/same_interp/perlrun_cached/perlrun_cached_constant.pl";
+$same_interp = Apache::TestRequest::same_interp_tie($url);
+for (1..2) {
+    my $res = same_interp_req_body($same_interp, \&GET, $url);
+    same_interp_skip_not_found(
+        !defined($res),
+        $res,
+        "42,42,1,1",
+        "constant subs kept, run $_",
+    );
+}
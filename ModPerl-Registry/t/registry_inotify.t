@@ -0,0 +1,47 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+use Apache::TestRequest qw(GET);
+use TestCommon::SameInterp;
+
+use File::Spec::Functions;
+
+# the location is configured with RegistryInotify On: the second
+# request adds the watch, so touching the script makes the third one
+# recompile it, without losing the compiles count of its cache entry
+
+plan tests => 2, need [qw(mod_alias.c HTML::HeadParser Linux::Inotify2)];
+
+my $file = 'cache_stats.pl';
+my $path = catfile Apache::Test::config()->{vars}->{serverroot},
+    'cgi-bin', $file;
+my $orig_mtime = (stat($path))[8];
+
+my $url = "/same_interp/registry_inotify/$file";
+my $same_interp = Apache::TestRequest::same_interp_tie($url);
+
+my $first  = same_interp_req_body($same_interp, \&GET, $url);
+my $second = same_interp_req_body($same_interp, \&GET, $url);
+same_interp_skip_not_found(
+    (scalar(grep defined, $first, $second) != 2),
+    $second,
+    1,
+    "the script is cached",
+);
+
+# push the mtime into the future, the watch sees the attribute change
+my $time = time + 5;
+utime $time, $time, $path;
+
+my $third = same_interp_req_body($same_interp, \&GET, $url);
+same_interp_skip_not_found(
+    (scalar(grep defined, $first, $second, $third) != 3),
+    $third,
+    2,
+    "the watch invalidated the script and its stats were kept",
+);
+
+utime $orig_mtime, $orig_mtime, $path;
@@ -0,0 +1,34 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+use Apache::TestRequest;
+
+use File::Spec::Functions;
+
+plan tests => 4, need 'mod_alias.c';
+
+# the scripts under cgi-bin/preload are compiled at startup by
+# ModPerl::RegistryLoader->load_dir, see modperl_extra_startup.pl
+
+{
+    my $url = "/registry/preload/compiled.pl";
+    ok t_cmp(GET_BODY($url), "precompiled",
+             "script compiled in the parent at server startup");
+}
+
+{
+    my $vars = Apache::Test::config()->{vars};
+    my $file = catfile $vars->{t_logs}, "registry_preload.txt";
+    open my $fh, $file or die "can't open $file: $!";
+    my @lines = <$fh>;
+    close $fh;
+
+    ok t_cmp(scalar(@lines), 2, "report header and one script entry");
+
+    my ($uri, $filename, $status) = split /\t/, $lines[1];
+    ok t_cmp($uri, "/registry/preload/compiled.pl", "reported uri");
+    ok t_cmp($status, "ok", "reported status");
+}
@@ -0,0 +1,48 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+use Apache::TestRequest qw(GET);
+use TestCommon::SameInterp;
+
+# the location is configured with RegistryCacheMaxScripts 1, so
+# running another script evicts closure.pl and resets its closure,
+# but not the scripts cached by the locations without limits
+
+plan tests => 3, need [qw(mod_alias.c HTML::HeadParser)];
+
+my $base = "/same_interp/registry_lru";
+my $url  = "$base/closure.pl";
+my $same_interp = Apache::TestRequest::same_interp_tie($url);
+
+# cached outside of the limited location
+my $unlimited = "/same_interp/registry/closure.pl";
+my $before = same_interp_req_body($same_interp, \&GET, $unlimited);
+
+my $first  = same_interp_req_body($same_interp, \&GET, $url);
+my $second = same_interp_req_body($same_interp, \&GET, $url);
+same_interp_skip_not_found(
+    (scalar(grep defined, $first, $second) != 2),
+    $first && $second && ($second - $first),
+    1,
+    "the script is cached",
+);
+
+my $other = same_interp_req_body($same_interp, \&GET, "$base/basic.pl");
+my $third = same_interp_req_body($same_interp, \&GET, $url);
+same_interp_skip_not_found(
+    (scalar(grep defined, $first, $other, $third) != 3),
+    $third,
+    1,
+    "the script was evicted and recompiled",
+);
+
+my $after = same_interp_req_body($same_interp, \&GET, $unlimited);
+same_interp_skip_not_found(
+    (scalar(grep defined, $before, $after) != 2),
+    $before && $after && ($after - $before),
+    1,
+    "scripts cached under other limits are not evicted",
+);
@@ -0,0 +1,43 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+use Apache::TestRequest;
+
+use File::Spec::Functions;
+use DirHandle ();
+
+plan tests => 6, need 'mod_alias.c';
+
+my $url = "/registry_source_cache/source_cache.pl";
+
+# the second request is served from the source cache if it runs in
+# another interpreter or process
+for (1..2) {
+    ok t_cmp(GET_BODY($url), "ok source cache", "script output");
+}
+
+my $dir = catdir Apache::Test::vars('t_logs'), 'source_cache';
+my $dh = DirHandle->new($dir) or die "can't open $dir: $!";
+my @files = grep !/^\./, $dh->read;
+
+ok t_cmp(sprintf("%04o", (stat $dir)[2] & 07777), "0700",
+         "the cache directory is private");
+
+my ($data, $name) = ('', '');
+for my $file (@files) {
+    open my $fh, catfile($dir, $file) or die "can't open $file: $!";
+    local $/;
+    my $content = <$fh>;
+    ($data, $name) = ($content, $file) if $content =~ /ok source cache/;
+}
+
+ok t_cmp($name, qr/^ModPerl_3a_3aRegistry-/,
+         "the entries are keyed by class");
+
+ok t_cmp($data, qr/^14\nuse warnings;\n/,
+         "the shebang code is cached");
+ok t_cmp($data !~ /__END__/, 1,
+         "the __END__ segment is stripped");
@@ -43,6 +43,7 @@ sub package    { return shift->{'args'}->{'package'} }
 my @saved;
 sub save       { return $Apache2::PerlSections::Save }
 sub server     { return $Apache2::PerlSections::Server }
+sub text       { return $Apache2::PerlSections::TextConfig }
 sub saved      { return @saved }
 
 sub handler : method {
@@ -158,13 +159,28 @@ sub dump_hash {
 sub dump_section {
     my ($self, $name, $loc, $hash) = @_;
 
-    $self->add_config("<$name $loc>\n");
+    if ($self->text) {
+        $self->add_config("<$name $loc>\n");
 
-    for my $entry (keys %{ $hash || {} }) {
-        $self->dump_entry($entry, $hash->{$entry});
+        for my $entry (keys %{ $hash || {} }) {
+            $self->dump_entry($entry, $hash->{$entry});
+        }
+
+        $self->add_config("</$name>\n");
+        return;
+    }
+
+    # hand the section over already built, so it doesn't need to be
+    # stringified and parsed again
+    my @children;
+    {
+        local $self->{directives} = \@children;
+        for my $entry (keys %{ $hash || {} }) {
+            $self->dump_entry($entry, $hash->{$entry});
+        }
     }
 
-    $self->add_config("</$name>\n");
+    push @{ $self->directives }, [$name, $loc, \@children];
 }
 
 sub dump_array {
@@ -180,14 +196,14 @@ sub dump_entry {
     my $type = ref $entry;
 
     if ($type eq 'SCALAR') {
-        $self->add_config("$name $$entry\n");
+        $self->add_directive($name, $$entry);
     }
     elsif ($type eq 'ARRAY') {
         if (grep {ref} @$entry) {
             $self->dump_entry($name, $_) for @$entry;
         }
         else {
-            $self->add_config("$name @$entry\n");
+            $self->add_directive($name, "@$entry");
         }
     }
     elsif ($type eq 'HASH') {
@@ -198,7 +214,18 @@ sub dump_entry {
         die "Unknown type '$type' for directive $name";
     }
     elsif (defined $entry) {
-        $self->add_config("$name $entry\n");
+        $self->add_directive($name, $entry);
+    }
+}
+
+sub add_directive {
+    my ($self, $name, $args) = @_;
+
+    if ($self->text) {
+        $self->add_config("$name $args\n");
+    }
+    else {
+        push @{ $self->directives }, [$name, $args];
     }
 }
 
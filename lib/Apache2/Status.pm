@@ -44,6 +44,9 @@ my %status = (
     env       => "Environment",
     sig       => "Signal Handlers",
     myconfig  => "Perl Configuration",
+    handlers_profile => "Perl Handlers Profile",
+    timelines => "Sampled Request Timelines",
+    unload_stats => "Package Unloading",
 );
 delete $status{'sig'} if IS_WIN32;
 
@@ -311,6 +314,149 @@ sub status_rgysubs {
         push @retval, "</p>\n";
     }
 
+    push @retval, registry_cache_stats();
+
+    \@retval;
+}
+
+# per-script stats recorded by ModPerl::RegistryCooker
+sub registry_cache_stats {
+    my $table = \%ModPerl::RegistryCache;
+    return unless %$table;
+
+    my @retval = ("<h2>Registry cache</h2>\n",
+        "<table border=1>\n<tr><th>Package</th><th>Cached</th>",
+        "<th>Hits</th><th>Compiles</th><th>Compile time (s)</th>",
+        "<th>Size (bytes)</th><th>Evictions</th><th>Last used</th></tr>\n");
+
+    for my $package (sort keys %$table) {
+        my $entry = $table->{$package};
+        push @retval, sprintf "<tr><td>%s</td><td>%s</td><td>%d</td>" .
+            "<td>%d</td><td>%.4f</td><td>%d</td><td>%d</td><td>%s</td></tr>\n",
+            escape_html($package), exists $entry->{mtime} ? "yes" : "no",
+            $entry->{hits} || 0, $entry->{compiles} || 0,
+            $entry->{compile_time} || 0, $entry->{size} || 0,
+            $entry->{evictions} || 0,
+            $entry->{atime} ? scalar localtime $entry->{atime} : "";
+    }
+
+    push @retval, "</table>\n";
+
+    return @retval;
+}
+
+my @handlers_profile_fields =
+    qw(calls errors wall_total wall_min wall_max cpu_total cpu_min cpu_max);
+
+sub handlers_profile_status {
+    my $status = shift;
+    join ", ", map { "$_=$status->{$_}" } sort { $a <=> $b } keys %$status;
+}
+
+sub status_handlers_profile {
+    my ($r) = @_;
+
+    require ModPerl::Util;
+    my $uri = $r->location;
+    my $profile = ModPerl::Util::handlers_profile();
+
+    return ["<p>No handlers were profiled by this process, enable ",
+            "the profiler with <code>PerlOptions +ProfileHandlers</code>",
+            "</p>\n"] unless %$profile;
+
+    my @retval = (
+        qq(<p><a href="$uri?noh_handlers_profile">Plain text</a>, ),
+        "times are in milliseconds</p>\n",
+        '<table border="1">',
+        "<tr>",
+        (map "<td><b>$_</b></td>", 'Handler', 'Calls', 'Errors',
+             'Wall avg', 'Wall min', 'Wall max',
+             'CPU avg', 'CPU min', 'CPU max', 'Status'),
+        "</tr>\n"
+    );
+
+    my $ms = sub { sprintf "%.3f", $_[0] / 1000 };
+    for my $name (sort { $profile->{$b}{wall_total} <=>
+                         $profile->{$a}{wall_total} } keys %$profile) {
+        my $e = $profile->{$name};
+        push @retval, (
+            "<tr>",
+            (map "<td>$_</td>",
+                escape_html($name), $e->{calls}, $e->{errors},
+                $ms->($e->{wall_total} / $e->{calls}),
+                $ms->($e->{wall_min}), $ms->($e->{wall_max}),
+                $ms->($e->{cpu_total} / $e->{calls}),
+                $ms->($e->{cpu_min}), $ms->($e->{cpu_max}),
+                handlers_profile_status($e->{status})),
+            "</tr>\n"
+        );
+    }
+    push @retval, "</table>\n";
+
+    \@retval;
+}
+
+# machine readable version of status_handlers_profile: one tab
+# separated line per handler, times are in microseconds
+sub noh_handlers_profile {
+    my $r = shift;
+
+    require ModPerl::Util;
+    $r->content_type("text/plain");
+
+    my $profile = ModPerl::Util::handlers_profile();
+    $r->print(join("\t", 'handler', @handlers_profile_fields, 'status'), "\n");
+    for my $name (sort keys %$profile) {
+        my $e = $profile->{$name};
+        $r->print(join("\t", $name, @$e{@handlers_profile_fields},
+                       handlers_profile_status($e->{status})), "\n");
+    }
+}
+
+sub status_timelines {
+    my ($r) = @_;
+
+    require ModPerl::Util;
+    my $uri = $r->location;
+    my $timelines = ModPerl::Util::timelines();
+
+    return ["<p>No requests were sampled by this process, enable ",
+            "sampling with <code>PerlTimelineSample N</code></p>\n"]
+        unless @$timelines;
+
+    return [qq(<p><a href="$uri?noh_timelines">JSON lines</a></p>\n),
+            "<pre>", (map { escape_html($_) . "\n" } @$timelines), "</pre>\n"];
+}
+
+# one JSON record per line, oldest first
+sub noh_timelines {
+    my $r = shift;
+
+    require ModPerl::Util;
+    $r->content_type("text/plain");
+    $r->print(map { "$_\n" } @{ ModPerl::Util::timelines() });
+}
+
+sub status_unload_stats {
+    my ($r) = @_;
+
+    require ModPerl::Util;
+    my $stats = ModPerl::Util::unload_package_stats();
+
+    return ["<p>No packages were unloaded by this process</p>\n"]
+        unless $stats->{calls};
+
+    my @retval = ('<table border="1">');
+    push @retval, map { "<tr><td>$_->[0]</td><td>$_->[1]</td></tr>\n" }
+        ["Unload calls",          $stats->{calls}],
+        ["Packages unloaded",     $stats->{packages}],
+        ["Symbols deleted",       $stats->{symbols}],
+        ["Shared objects closed", $stats->{dl_closed}],
+        ["Total time (ms)",       sprintf "%.3f", $stats->{time} / 1000],
+        ["Average time (ms)",
+         sprintf "%.3f", $stats->{time} / $stats->{calls} / 1000];
+    push @retval, "</table>\n";
+
     \@retval;
 }
 
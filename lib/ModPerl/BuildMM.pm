@@ -155,7 +155,8 @@ sub WriteMakefile {
 }
 
 my %always_dynamic = map { $_, 1 }
-  qw(ModPerl::Const Apache2::Const APR::Const APR APR::PerlIO);
+  qw(ModPerl::Const Apache2::Const APR::Const APR APR::PerlIO
+     APR::SHMCache);
 
 sub ModPerl::BuildMM::MY::constants {
     my $self = shift;
@@ -139,7 +139,7 @@ my @hook_flags = sort(map { canon_uc($_) } keys %hooks);
 my @ithread_opts = qw(CLONE PARENT);
 my %flags = (
     Srv => ['NONE', @ithread_opts, qw(ENABLE AUTOLOAD MERGE_HANDLERS),
-            @hook_flags, 'UNSET','INHERIT_SWITCHES'],
+            @hook_flags, 'UNSET','INHERIT_SWITCHES','PROFILE_HANDLERS'],
     Dir => [qw(NONE PARSE_HEADERS SETUP_ENV MERGE_HANDLERS GLOBAL_REQUEST UNSET)],
     Req => [qw(NONE SET_GLOBAL_REQUEST PARSE_HEADERS SETUP_ENV
                CLEANUP_REGISTERED PERL_SET_ENV_DIR PERL_SET_ENV_SRV)],
@@ -658,7 +658,8 @@ my @c_src_names = qw(interp tipool log config cmd options callback handler
                      gtop util io io_apache filter bucket mgv pcw global env
                      cgi perl perl_global perl_pp sys module svptr_table
                      const constants apache_compat error debug
-                     common_util common_log);
+                     common_util common_log profile timeline
+                     log_async log_fields startup_profile arena);
 my @h_src_names = qw(perl_unembed);
 my @g_c_names = map { "modperl_$_" } qw(hooks directives flags xsinit exports);
 my @c_names   = ('mod_perl', (map "modperl_$_", @c_src_names));
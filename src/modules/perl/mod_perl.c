@@ -488,11 +488,26 @@ static int modperl_post_config_require(server_rec *s, apr_pool_t *p)
     return TRUE;
 }
 
+static int modperl_warmup(server_rec *s, apr_pool_t *p)
+{
+    for (; s; s=s->next) {
+        MP_dSCFG(s);
+        if (!modperl_config_apply_PerlWarmupHandler(s, scfg, p)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
 #ifdef USE_ITHREADS
 static void modperl_init_clones(server_rec *s, apr_pool_t *p)
 {
-#ifdef MP_TRACE
     modperl_config_srv_t *base_scfg = modperl_config_srv_get(s);
+    int threads = base_scfg->interp_clone_threads;
+    apr_array_header_t *tipools =
+        apr_array_make(p, 1, sizeof(modperl_tipool_t *));
+    modperl_tipool_t **elts;
+#ifdef MP_TRACE
     char *base_name = modperl_server_desc(s, p);
 #endif /* MP_TRACE */
 
@@ -503,13 +518,22 @@ static void modperl_init_clones(server_rec *s, apr_pool_t *p)
 
     for (; s; s=s->next) {
         MP_dSCFG(s);
+        int i, queued = FALSE;
 #ifdef MP_TRACE
         char *name = modperl_server_desc(s, p);
 #else
         char *name = NULL;
 #endif /* MP_TRACE */
 
-        if (scfg->mip->tipool->idle) {
+        /* the pools are only grown once they are all collected */
+        elts = (modperl_tipool_t **)tipools->elts;
+        for (i = 0; i < tipools->nelts; i++) {
+            if (elts[i] == scfg->mip->tipool) {
+                queued = TRUE;
+            }
+        }
+
+        if (scfg->mip->tipool->idle || queued) {
 #ifdef MP_TRACE
             if (scfg->mip == base_scfg->mip) {
                 MP_TRACE_i(MP_FUNC,
@@ -526,9 +550,17 @@ static void modperl_init_clones(server_rec *s, apr_pool_t *p)
         else {
             MP_TRACE_i(MP_FUNC, "initializing interp pool for %s",
                        name);
-            modperl_tipool_init(scfg->mip->tipool);
+
+            /* each pool clones its own parent, the base server's or
+             * a +Parent vhost's, so only different pools are grown
+             * concurrently */
+            *(modperl_tipool_t **)apr_array_push(tipools) =
+                scfg->mip->tipool;
         }
     }
+
+    modperl_tipool_init_concurrent(p, (modperl_tipool_t **)tipools->elts,
+                                   tipools->nelts, threads);
 }
 #endif /* USE_ITHREADS */
 
@@ -545,6 +577,20 @@ void modperl_init_globals(server_rec *s, apr_pool_t *pconf)
 
     /* init the counter to 0 */
     modperl_global_anon_cnt_init(pconf);
+
+#ifdef USE_ITHREADS
+    modperl_mgv_cache_init(pconf);
+#endif
+
+    modperl_profile_init(pconf);
+    modperl_timeline_init(pconf);
+    modperl_package_unload_init(pconf);
+    modperl_log_async_init(pconf);
+    modperl_module_merge_cache_init(pconf);
+    modperl_startup_profile_init(pconf);
+    modperl_config_insert_cache_init(pconf);
+    modperl_config_dir_index_init(pconf);
+    modperl_arena_init(pconf);
 }
 
 /*
@@ -682,6 +728,8 @@ static int modperl_hook_post_config_last(apr_pool_t *pconf, apr_pool_t *plog,
         exit(1);
     }
 
+    modperl_config_configvars_index(s, pconf);
+
     if (modperl_threaded_mpm()) {
         MP_threads_started = 1;
     }
@@ -721,6 +769,15 @@ static int modperl_hook_post_config_last(apr_pool_t *pconf, apr_pool_t *plog,
     modperl_mgv_hash_handlers(pconf, s);
     modperl_modglobal_hash_keys(aTHX);
     modperl_env_hash_keys(aTHX);
+
+    /* run after the handlers were resolved and before the clones are
+     * made, so the clones start with everything already warmed up */
+    if (!modperl_warmup(s, pconf)) {
+        exit(1);
+    }
+
+    modperl_startup_profile_write(s, pconf);
+
 #ifdef USE_ITHREADS
     modperl_init_clones(s, pconf);
 #endif
@@ -753,6 +810,7 @@ static int modperl_hook_create_request(request_rec *r)
 
     modperl_config_req_init(r, rcfg);
     modperl_config_req_cleanup_register(r, rcfg);
+    modperl_timeline_sample(r, rcfg);
 
     /* set the default for cgi header parsing On as early as possible
      * so $r->content_type in any phase after header_parser could turn
@@ -847,6 +905,8 @@ static void modperl_hook_child_init(apr_pool_t *p, server_rec *s)
 
     apr_pool_cleanup_register(p, (void *)s, modperl_child_exit,
                               apr_pool_cleanup_null);
+
+    modperl_log_async_child_init(p, s);
 }
 
 #define MP_FILTER_HANDLER(f) f, NULL
@@ -919,6 +979,11 @@ void modperl_register_hooks(apr_pool_t *p)
     ap_hook_child_init(modperl_hook_child_init,
                        NULL, NULL, MODPERL_HOOK_REALLY_REALLY_FIRST);
 
+    /* after PerlLogHandler, which may add fields, and before
+     * mod_log_config, which may log the note */
+    ap_hook_log_transaction(modperl_log_fields_emit,
+                            NULL, NULL, APR_HOOK_FIRST);
+
     modperl_register_handler_hooks();
 }
 
@@ -953,6 +1018,20 @@ static const command_rec modperl_cmds[] = {
     MP_CMD_DIR_RAW_ARGS_ON_READ("__END__", END, "Stop reading config"),
 
     MP_CMD_SRV_RAW_ARGS("PerlLoadModule", load_module, "A Perl module"),
+    MP_CMD_SRV_TAKE1("PerlTimelineSample", timeline_sample,
+                     "Record the timeline of 1 out of N requests"),
+    MP_CMD_SRV_TAKE1("PerlLogAsync", log_async,
+                     "Size of the ring of the asynchronous log writer"),
+    MP_CMD_SRV_TAKE1("PerlStartupProfile", startup_profile,
+                     "File to write the startup profile to"),
+    MP_CMD_SRV_ITERATE("PerlWarmupHandler", warmup_handlers,
+                       "Subroutine name"),
+    MP_CMD_SRV_TAKE1("PerlAddConfigCache", add_config_cache,
+                     "Max number of $r->add_config() config vectors "
+                     "to cache"),
+    MP_CMD_SRV_TAKE1("PerlRequestArena", request_arena,
+                     "Max number of spare handler arguments and pnotes "
+                     "to keep per interpreter"),
 #ifdef MP_TRACE
     MP_CMD_SRV_TAKE1("PerlTrace", trace, "Trace level"),
 #endif
@@ -967,6 +1046,9 @@ static const command_rec modperl_cmds[] = {
                      "Min number of spare Perl interpreters"),
     MP_CMD_SRV_TAKE1("PerlInterpMaxRequests", interp_max_requests,
                      "Max number of requests per Perl interpreters"),
+    MP_CMD_SRV_TAKE1("PerlInterpCloneThreads", interp_clone_threads,
+                     "Number of threads cloning the PerlInterpStart "
+                     "interpreters"),
 #endif
 #ifdef MP_COMPAT_1X
     MP_CMD_DIR_FLAG("PerlSendHeader", send_header,
@@ -92,6 +92,12 @@ extern module AP_MODULE_DECLARE_DATA perl_module;
 #include "modperl_perl.h"
 #include "modperl_svptr_table.h"
 #include "modperl_module.h"
+#include "modperl_profile.h"
+#include "modperl_timeline.h"
+#include "modperl_log_async.h"
+#include "modperl_log_fields.h"
+#include "modperl_startup_profile.h"
+#include "modperl_arena.h"
 #include "modperl_debug.h"
 
 int modperl_threads_started(void);
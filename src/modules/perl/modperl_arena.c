@@ -0,0 +1,385 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+
+/* the max number of spares kept per kind, 0 == don't recycle */
+static int MP_arena_size = 0;
+
+/* set by PerlRequestArena, even with a size of 0, so the stats can be
+ * compared with and without recycling */
+static int MP_arena_on = 0;
+
+#define MP_ARENA_KEY "ModPerl::RequestArena"
+
+/* the arena of each interpreter is an AV in PL_modglobal */
+enum {
+    MP_ARENA_AVS,   /* spare handler argument AVs */
+    MP_ARENA_HVS,   /* spare pnotes HVs */
+    MP_ARENA_OBJS,  /* class => [spare wrappers], or 0 if not recyclable */
+    MP_ARENA_STATS, /* modperl_arena_stats_t in a PV */
+    MP_ARENA_NELTS
+};
+
+typedef struct {
+    IV requests;
+    IV created;
+    IV reused;
+    IV escaped;   /* still referenced by perl code when released */
+    IV sv_growth; /* sum of the PL_sv_count growth over the requests */
+    IV sv_count;  /* PL_sv_count when the last request was done */
+} modperl_arena_stats_t;
+
+#define MP_ARENA_ELT(arena, i) AvARRAY(arena)[i]
+
+#define MP_ARENA_STATS_GET(arena) \
+    ((modperl_arena_stats_t *)SvPVX(MP_ARENA_ELT(arena, MP_ARENA_STATS)))
+
+void modperl_arena_init(apr_pool_t *p)
+{
+    /* re-read on restart */
+    MP_arena_size = 0;
+    MP_arena_on = 0;
+}
+
+const char *modperl_arena_size_set(const char *arg)
+{
+    MP_arena_size = atoi(arg);
+
+    if (MP_arena_size < 0) {
+        return "PerlRequestArena: the size must be a positive number";
+    }
+
+    MP_arena_on = 1;
+
+    return NULL;
+}
+
+static AV *modperl_arena_get(pTHX)
+{
+    SV **svp;
+
+#if MP_PERL_VERSION_AT_LEAST(5, 10, 0)
+    static U32 hash = 0;
+
+    if (!hash) {
+        PERL_HASH(hash, MP_ARENA_KEY, MP_SSTRLEN(MP_ARENA_KEY));
+    }
+
+    svp = (SV **)hv_common_key_len(PL_modglobal,
+                                   MP_ARENA_KEY, MP_SSTRLEN(MP_ARENA_KEY),
+                                   HV_FETCH_JUST_SV|HV_FETCH_LVALUE,
+                                   NULL, hash);
+#else
+    svp = hv_fetch(PL_modglobal, MP_ARENA_KEY, MP_SSTRLEN(MP_ARENA_KEY),
+                   TRUE);
+#endif
+
+    if (!SvROK(*svp)) {
+        AV *arena = newAV();
+        SV *stats = newSV(sizeof(modperl_arena_stats_t));
+        SV *rv;
+
+        Zero(SvPVX(stats), 1, modperl_arena_stats_t);
+
+        av_extend(arena, MP_ARENA_NELTS - 1);
+        av_store(arena, MP_ARENA_AVS,   (SV *)newAV());
+        av_store(arena, MP_ARENA_HVS,   (SV *)newAV());
+        av_store(arena, MP_ARENA_OBJS,  (SV *)newHV());
+        av_store(arena, MP_ARENA_STATS, stats);
+
+        rv = newRV_noinc((SV *)arena);
+        sv_setsv(*svp, rv);
+        SvREFCNT_dec(rv);
+    }
+
+    return (AV *)SvRV(*svp);
+}
+
+/* pop a spare off the given list, NULL if there is none */
+static SV *modperl_arena_spare(pTHX_ int kind)
+{
+    AV *arena = modperl_arena_get(aTHX);
+    AV *spares = (AV *)MP_ARENA_ELT(arena, kind);
+    modperl_arena_stats_t *stats = MP_ARENA_STATS_GET(arena);
+
+    if (AvFILLp(spares) >= 0) {
+        stats->reused++;
+        return av_pop(spares);
+    }
+
+    stats->created++;
+    return (SV *)NULL;
+}
+
+/* keep sv as a spare if there is room left, otherwise free it */
+static void modperl_arena_keep(pTHX_ AV *spares, SV *sv)
+{
+    if (AvFILLp(spares) + 1 < MP_arena_size) {
+        av_push(spares, sv);
+    }
+    else {
+        SvREFCNT_dec(sv);
+    }
+}
+
+AV *modperl_arena_av(pTHX)
+{
+    AV *av;
+
+    if (MP_arena_on &&
+        (av = (AV *)modperl_arena_spare(aTHX_ MP_ARENA_AVS))) {
+        return av;
+    }
+
+    return newAV();
+}
+
+HV *modperl_arena_hv(pTHX)
+{
+    HV *hv;
+
+    if (MP_arena_on &&
+        (hv = (HV *)modperl_arena_spare(aTHX_ MP_ARENA_HVS))) {
+        return hv;
+    }
+
+    return newHV();
+}
+
+SV *modperl_arena_ptr2obj(pTHX_ char *classname, void *ptr)
+{
+    /* a NULL ptr is undef, not a wrapper */
+    if (MP_arena_on && ptr) {
+        AV *arena = modperl_arena_get(aTHX);
+        HV *objs = (HV *)MP_ARENA_ELT(arena, MP_ARENA_OBJS);
+        SV **svp = hv_fetch(objs, classname, strlen(classname), FALSE);
+
+        if (svp && SvROK(*svp) && AvFILLp((AV *)SvRV(*svp)) >= 0) {
+            SV *rv = av_pop((AV *)SvRV(*svp));
+
+            MP_TRACE_m(MP_FUNC, "reusing %s wrapper 0x%lx for 0x%lx",
+                       classname, (unsigned long)rv, (unsigned long)ptr);
+
+            sv_setiv(SvRV(rv), PTR2IV(ptr));
+            MP_ARENA_STATS_GET(arena)->reused++;
+            return rv;
+        }
+
+        MP_ARENA_STATS_GET(arena)->created++;
+    }
+
+    return modperl_ptr2obj(aTHX_ classname, ptr);
+}
+
+/* a wrapper made by modperl_ptr2obj() goes back to the spares of its
+ * class, unless perl code is holding on to it or attached anything to
+ * it.  returns TRUE if it was kept */
+static int modperl_arena_obj_release(pTHX_ AV *arena, SV *rv)
+{
+    HV *objs = (HV *)MP_ARENA_ELT(arena, MP_ARENA_OBJS);
+    SV *obj, **svp;
+    HV *stash;
+    const char *name;
+    AV *spares;
+
+    if (!rv || SvREFCNT(rv) != 1 || SvMAGICAL(rv) || !SvROK(rv)) {
+        return FALSE;
+    }
+
+    obj = SvRV(rv);
+    if (!SvOBJECT(obj) || SvTYPE(obj) != SVt_PVMG || !SvIOK(obj) ||
+        SvMAGICAL(obj) || SvREADONLY(obj)) {
+        return FALSE;
+    }
+
+    if (SvREFCNT(obj) != 1) {
+        MP_ARENA_STATS_GET(arena)->escaped++;
+        return FALSE;
+    }
+
+    stash = SvSTASH(obj);
+    if (!(name = HvNAME(stash))) {
+        return FALSE;
+    }
+
+    svp = hv_fetch(objs, name, strlen(name), TRUE);
+    if (!SvOK(*svp)) {
+        /* decided once per class: recycling a wrapper would skip its
+         * DESTROY method */
+        if (gv_fetchmethod_autoload(stash, "DESTROY", TRUE)) {
+            MP_TRACE_m(MP_FUNC, "%s has a DESTROY method, "
+                       "its wrappers are not recycled", name);
+            sv_setiv(*svp, 0);
+        }
+        else {
+            SV *av_rv = newRV_noinc((SV *)newAV());
+            sv_setsv(*svp, av_rv);
+            SvREFCNT_dec(av_rv);
+        }
+    }
+
+    if (!SvROK(*svp)) {
+        return FALSE;
+    }
+
+    spares = (AV *)SvRV(*svp);
+    if (AvFILLp(spares) + 1 >= MP_arena_size) {
+        return FALSE;
+    }
+
+    av_push(spares, rv);
+
+    return TRUE;
+}
+
+void modperl_arena_av_release(pTHX_ AV *av)
+{
+    AV *arena;
+    SSize_t i;
+
+    if (!av) {
+        return;
+    }
+
+    if (!MP_arena_on || SvMAGICAL(av) || SvOBJECT(av) || !AvREAL(av)) {
+        SvREFCNT_dec((SV *)av);
+        return;
+    }
+
+    arena = modperl_arena_get(aTHX);
+
+    if (SvREFCNT(av) > 1 || !MP_arena_size) {
+        if (SvREFCNT(av) > 1) {
+            MP_ARENA_STATS_GET(arena)->escaped++;
+        }
+        SvREFCNT_dec((SV *)av);
+        return;
+    }
+
+    for (i = 0; i <= AvFILLp(av); i++) {
+        if (modperl_arena_obj_release(aTHX_ arena, AvARRAY(av)[i])) {
+            AvARRAY(av)[i] = (SV *)NULL;
+        }
+    }
+
+    /* frees whatever wasn't kept, but keeps the AV's storage */
+    av_clear(av);
+
+    modperl_arena_keep(aTHX_ (AV *)MP_ARENA_ELT(arena, MP_ARENA_AVS),
+                       (SV *)av);
+}
+
+void modperl_arena_hv_release(pTHX_ HV *hv)
+{
+    AV *arena;
+
+    if (!hv) {
+        return;
+    }
+
+    if (!MP_arena_on || SvMAGICAL(hv) || SvOBJECT(hv) || SvREADONLY(hv)) {
+        SvREFCNT_dec((SV *)hv);
+        return;
+    }
+
+    arena = modperl_arena_get(aTHX);
+
+    if (SvREFCNT(hv) > 1 || !MP_arena_size) {
+        if (SvREFCNT(hv) > 1) {
+            MP_ARENA_STATS_GET(arena)->escaped++;
+        }
+        SvREFCNT_dec((SV *)hv);
+        return;
+    }
+
+    /* keeps the bucket array */
+    hv_clear(hv);
+    hv_iterinit(hv);
+
+    modperl_arena_keep(aTHX_ (AV *)MP_ARENA_ELT(arena, MP_ARENA_HVS),
+                       (SV *)hv);
+}
+
+void modperl_arena_request_done(pTHX_ request_rec *r)
+{
+    AV *arena;
+    modperl_arena_stats_t *stats;
+    IV count = (IV)PL_sv_count, growth;
+
+    if (!MP_arena_on) {
+        return;
+    }
+
+    arena = modperl_arena_get(aTHX);
+    stats = MP_ARENA_STATS_GET(arena);
+
+    /* the first request only tells where we start from */
+    growth = stats->requests ? count - stats->sv_count : 0;
+    stats->sv_growth += growth;
+    stats->sv_count = count;
+    stats->requests++;
+
+    MP_TRACE_m(MP_FUNC, "%s: %ld SVs (%ld more), "
+               "%ld reused, %ld created so far", r->uri, (long)count,
+               (long)growth, (long)stats->reused, (long)stats->created);
+}
+
+#define MP_ARENA_STATS_STORE(name, val)                 \
+    (void)hv_store(hv, name, MP_SSTRLEN(name), val, 0)
+
+SV *modperl_arena_stats(pTHX)
+{
+    HV *hv = newHV();
+    AV *arena = modperl_arena_get(aTHX);
+    modperl_arena_stats_t *stats = MP_ARENA_STATS_GET(arena);
+    HV *objs = (HV *)MP_ARENA_ELT(arena, MP_ARENA_OBJS);
+    IV spares = AvFILLp((AV *)MP_ARENA_ELT(arena, MP_ARENA_AVS)) + 1 +
+        AvFILLp((AV *)MP_ARENA_ELT(arena, MP_ARENA_HVS)) + 1;
+    HE *he;
+
+    hv_iterinit(objs);
+    while ((he = hv_iternext(objs))) {
+        SV *sv = HeVAL(he);
+        if (SvROK(sv)) {
+            spares += AvFILLp((AV *)SvRV(sv)) + 1;
+        }
+    }
+
+    MP_ARENA_STATS_STORE("size",      newSViv(MP_arena_on ? MP_arena_size
+                                              : -1));
+    MP_ARENA_STATS_STORE("requests",  newSViv(stats->requests));
+    MP_ARENA_STATS_STORE("created",   newSViv(stats->created));
+    MP_ARENA_STATS_STORE("reused",    newSViv(stats->reused));
+    MP_ARENA_STATS_STORE("escaped",   newSViv(stats->escaped));
+    MP_ARENA_STATS_STORE("spares",    newSViv(spares));
+    MP_ARENA_STATS_STORE("sv_count",  newSViv((IV)PL_sv_count));
+    MP_ARENA_STATS_STORE("sv_growth", newSViv(stats->sv_growth));
+    MP_ARENA_STATS_STORE("sv_growth_per_request",
+                         newSVnv(stats->requests > 1
+                                 ? (NV)stats->sv_growth /
+                                   (NV)(stats->requests - 1)
+                                 : 0.0));
+
+    return newRV_noinc((SV *)hv);
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,55 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODPERL_ARENA_H
+#define MODPERL_ARENA_H
+
+/*
+ * request arena enabled by PerlRequestArena N: the argument AVs and
+ * the object wrappers mod_perl creates for the request phase handlers,
+ * and the pnotes HVs, are kept by each interpreter once the request is
+ * done with them and reused by the following requests, instead of
+ * being freed and allocated again.  anything perl code still holds a
+ * reference to is left alone.  N is the max number of spare containers
+ * kept per kind (and per class for the object wrappers).
+ */
+
+void modperl_arena_init(apr_pool_t *p);
+
+const char *modperl_arena_size_set(const char *arg);
+
+AV *modperl_arena_av(pTHX);
+
+void modperl_arena_av_release(pTHX_ AV *av);
+
+HV *modperl_arena_hv(pTHX);
+
+void modperl_arena_hv_release(pTHX_ HV *hv);
+
+SV *modperl_arena_ptr2obj(pTHX_ char *classname, void *ptr);
+
+void modperl_arena_request_done(pTHX_ request_rec *r);
+
+SV *modperl_arena_stats(pTHX);
+
+#endif /* MODPERL_ARENA_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
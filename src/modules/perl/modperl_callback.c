@@ -23,6 +23,8 @@ int modperl_callback(pTHX_ modperl_handler_t *handler, apr_pool_t *p,
     I32 flags = G_EVAL|G_SCALAR;
     dSP;
     int count, status = OK;
+    int profile = FALSE;
+    modperl_times_t start_times, end_times;
 
     /* handler callbacks shouldn't affect each other's taintedness
      * state, so start every callback with a clear tainted status
@@ -97,6 +99,11 @@ int modperl_callback(pTHX_ modperl_handler_t *handler, apr_pool_t *p,
     }
 
     if (status == OK) {
+        if (s && MpSrvPROFILE_HANDLERS(modperl_config_srv_get(s))) {
+            profile = TRUE;
+            MP_TIMES_NOW(start_times);
+        }
+
         count = call_sv((SV*)cv, flags);
 
         SPAGAIN;
@@ -128,6 +135,13 @@ int modperl_callback(pTHX_ modperl_handler_t *handler, apr_pool_t *p,
         status = HTTP_INTERNAL_SERVER_ERROR;
     }
 
+    if (profile) {
+        MP_TIMES_NOW(end_times);
+        modperl_profile_record(modperl_handler_name(handler),
+                               &start_times, &end_times, status,
+                               SvTRUE(ERRSV));
+    }
+
     if (status == HTTP_INTERNAL_SERVER_ERROR) {
         if (r && r->notes) {
             apr_table_merge(r->notes, "error-notes", SvPV_nolen(ERRSV));
@@ -157,6 +171,7 @@ int modperl_callback_run_handlers(int idx, int type,
     int i, status = OK;
     const char *desc = NULL;
     AV *av_args = (AV *)NULL;
+    apr_time_t phase_start;
 
     if (!MpSrvENABLE(scfg)) {
         MP_TRACE_h(MP_FUNC, "PerlOff for server %s:%u",
@@ -180,6 +195,8 @@ int modperl_callback_run_handlers(int idx, int type,
         return DECLINED;
     }
 
+    phase_start = modperl_timeline_now(r);
+
     MP_INTERPa(r, c, s);
 
     switch (type) {
@@ -329,10 +346,17 @@ int modperl_callback_run_handlers(int idx, int type,
         }
     }
 
-    SvREFCNT_dec((SV*)av_args);
+    if (r) {
+        modperl_arena_av_release(aTHX_ av_args);
+    }
+    else {
+        SvREFCNT_dec((SV*)av_args);
+    }
 
     MP_INTERP_PUTBACK(interp, aTHX);
 
+    modperl_timeline_add(r, "phase", desc, phase_start);
+
     return status;
 }
 
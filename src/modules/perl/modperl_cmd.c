@@ -759,6 +759,53 @@ MP_CMD_SRV_DECLARE(set_output_filter)
 }
 
 
+MP_CMD_SRV_DECLARE(timeline_sample)
+{
+    MP_dSCFG(parms->server);
+    scfg->timeline_sample = atoi(arg);
+    MP_TRACE_d(MP_FUNC, "%s %d", parms->cmd->name, scfg->timeline_sample);
+    return NULL;
+}
+
+MP_CMD_SRV_DECLARE(log_async)
+{
+    MP_CMD_SRV_CHECK;
+    return modperl_log_async_size_set(arg);
+}
+
+MP_CMD_SRV_DECLARE(startup_profile)
+{
+    MP_CMD_SRV_CHECK;
+    return modperl_startup_profile_file_set(parms->pool, arg);
+}
+
+MP_CMD_SRV_DECLARE(warmup_handlers)
+{
+    MP_dSCFG(parms->server);
+    MP_TRACE_d(MP_FUNC, "push PerlWarmupHandler %s", arg);
+    *(const char **)apr_array_push(scfg->PerlWarmupHandler) = arg;
+    return NULL;
+}
+
+MP_CMD_SRV_DECLARE(add_config_cache)
+{
+    MP_dSCFG(parms->server);
+    scfg->add_config_cache = atoi(arg);
+    MP_TRACE_d(MP_FUNC, "%s %d", parms->cmd->name, scfg->add_config_cache);
+
+    if (scfg->add_config_cache < 0) {
+        return "PerlAddConfigCache: the cache size must be a positive number";
+    }
+
+    return NULL;
+}
+
+MP_CMD_SRV_DECLARE(request_arena)
+{
+    MP_CMD_SRV_CHECK;
+    return modperl_arena_size_set(arg);
+}
+
 #ifdef MP_COMPAT_1X
 
 MP_CMD_SRV_DECLARE_FLAG(taint_check)
@@ -812,6 +859,19 @@ MP_CMD_INTERP_POOL_IMP(max_spare);
 MP_CMD_INTERP_POOL_IMP(min_spare);
 MP_CMD_INTERP_POOL_IMP(max_requests);
 
+MP_CMD_SRV_DECLARE(interp_clone_threads)
+{
+    MP_dSCFG(parms->server);
+    MP_CMD_SRV_CHECK;
+    scfg->interp_clone_threads = atoi(arg);
+    if (scfg->interp_clone_threads < 1) {
+        return "PerlInterpCloneThreads must be a positive number";
+    }
+    MP_TRACE_d(MP_FUNC, "%s %d", parms->cmd->name,
+               scfg->interp_clone_threads);
+    return NULL;
+}
+
 #endif /* USE_ITHREADS */
 
 /*
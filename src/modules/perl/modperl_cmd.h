@@ -61,6 +61,12 @@ MP_CMD_SRV_DECLARE(END);
 MP_CMD_SRV_DECLARE(load_module);
 MP_CMD_SRV_DECLARE(set_input_filter);
 MP_CMD_SRV_DECLARE(set_output_filter);
+MP_CMD_SRV_DECLARE(timeline_sample);
+MP_CMD_SRV_DECLARE(log_async);
+MP_CMD_SRV_DECLARE(startup_profile);
+MP_CMD_SRV_DECLARE(warmup_handlers);
+MP_CMD_SRV_DECLARE(add_config_cache);
+MP_CMD_SRV_DECLARE(request_arena);
 
 #ifdef MP_COMPAT_1X
 
@@ -77,6 +83,7 @@ MP_CMD_SRV_DECLARE(interp_max);
 MP_CMD_SRV_DECLARE(interp_max_spare);
 MP_CMD_SRV_DECLARE(interp_min_spare);
 MP_CMD_SRV_DECLARE(interp_max_requests);
+MP_CMD_SRV_DECLARE(interp_clone_threads);
 
 #endif /* USE_ITHREADS */
 
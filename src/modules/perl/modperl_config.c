@@ -162,6 +162,7 @@ modperl_config_srv_t *modperl_config_srv_new(apr_pool_t *p, server_rec *s)
     scfg->PerlRequire = apr_array_make(p, 2, sizeof(char *));
     scfg->PerlPostConfigRequire =
         apr_array_make(p, 1, sizeof(modperl_require_file_t *));
+    scfg->PerlWarmupHandler = apr_array_make(p, 1, sizeof(char *));
 
     scfg->argv = apr_array_make(p, 2, sizeof(char *));
 
@@ -189,6 +190,7 @@ modperl_config_dir_t *modperl_config_dir_new(apr_pool_t *p)
     modperl_config_dir_t *dcfg = (modperl_config_dir_t *)
         apr_pcalloc(p, sizeof(modperl_config_dir_t));
 
+    dcfg->pool = p;
     dcfg->flags = modperl_options_new(p, MpDirType);
 
     dcfg->setvars = apr_table_make(p, 2);
@@ -283,6 +285,7 @@ void *modperl_config_srv_merge(apr_pool_t *p, void *basev, void *addv)
     merge_item(PerlModule);
     merge_item(PerlRequire);
     merge_item(PerlPostConfigRequire);
+    merge_item(PerlWarmupHandler);
 
     merge_table_overlap_item(SetEnv);
     merge_table_overlap_item(PassEnv);
@@ -294,6 +297,8 @@ void *modperl_config_srv_merge(apr_pool_t *p, void *basev, void *addv)
     merge_table_overlap_item(setvars);
 
     merge_item(server);
+    merge_item(timeline_sample);
+    merge_item(add_config_cache);
 
 #ifdef USE_ITHREADS
     merge_item(interp_pool_cfg);
@@ -367,6 +372,8 @@ apr_status_t modperl_config_req_cleanup(void *data)
 
     rc = modperl_config_request_cleanup(aTHX_ r);
 
+    modperl_arena_request_done(aTHX_ r);
+
     MP_INTERP_PUTBACK(interp, aTHX);
 
     return rc;
@@ -466,6 +473,104 @@ int modperl_config_apply_PerlPostConfigRequire(server_rec *s,
     return TRUE;
 }
 
+int modperl_config_apply_PerlWarmupHandler(server_rec *s,
+                                           modperl_config_srv_t *scfg,
+                                           apr_pool_t *p)
+{
+    char **entries;
+    int i;
+    MP_PERL_CONTEXT_DECLARE;
+
+    entries = (char **)scfg->PerlWarmupHandler->elts;
+    for (i = 0; i < scfg->PerlWarmupHandler->nelts; i++){
+        modperl_handler_t *handler = modperl_handler_new(p, entries[i]);
+        modperl_startup_profile_entry_t *profile;
+        AV *av_args = (AV *)NULL;
+        int status;
+
+        MP_PERL_CONTEXT_STORE_OVERRIDE(scfg->mip->parent->perl);
+        profile = modperl_startup_profile_start(aTHX_ "warmup", entries[i]);
+        modperl_handler_make_args(aTHX_ &av_args,
+                                  "APR::Pool", p,
+                                  "Apache2::ServerRec", s, NULL);
+        status = modperl_callback(aTHX_ handler, p, NULL, s, av_args);
+        SvREFCNT_dec((SV*)av_args);
+        modperl_startup_profile_stop(aTHX_ profile, status == OK);
+        MP_PERL_CONTEXT_RESTORE;
+
+        if (status == OK) {
+            MP_TRACE_d(MP_FUNC, "ran PerlWarmupHandler %s for server %s",
+                       entries[i], modperl_server_desc(s, p));
+        }
+        else {
+            ap_log_error(APLOG_MARK, APLOG_ERR, 0, s,
+                         "PerlWarmupHandler %s failed for server %s, "
+                         "exiting...",
+                         entries[i], modperl_server_desc(s, p));
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+ * (re)build the PerlSetVar/PerlAddVar indexes of each server's own
+ * configs, once startup code is done modifying them.  the configs
+ * merged at request time are indexed by modperl_config_dir_index_get().
+ */
+void modperl_config_configvars_index(server_rec *s, apr_pool_t *p)
+{
+    for (; s; s=s->next) {
+        MP_dSCFG(s);
+        modperl_config_dir_t *dcfg =
+            modperl_get_module_config(s->lookup_defaults);
+
+        scfg->configvars_index =
+            modperl_table_index_make(p, scfg->configvars);
+
+        if (dcfg) {
+            dcfg->configvars_index =
+                modperl_table_index_make(p, dcfg->configvars);
+        }
+    }
+}
+
+/*
+ * most per-dir configs are merged for a request which never calls
+ * $r->dir_config('Key'), so their index is only built on the first
+ * keyed lookup, from the pool the config was merged in.  a merged
+ * config may be shared by several requests (e.g. with
+ * PerlAddConfigCache), hence the lock.
+ */
+static modperl_global_t MP_global_dir_index;
+
+void modperl_config_dir_index_init(apr_pool_t *p)
+{
+    modperl_global_init(&MP_global_dir_index, p, NULL, "dir_index");
+}
+
+modperl_table_index_t *
+modperl_config_dir_index_get(modperl_config_dir_t *dcfg)
+{
+    modperl_table_index_t *idx = dcfg->configvars_index;
+
+    if (idx || !dcfg->configvars ||
+        apr_table_elts(dcfg->configvars)->nelts < MP_TABLE_INDEX_MIN) {
+        return idx;
+    }
+
+    modperl_global_lock(&MP_global_dir_index);
+    if (!dcfg->configvars_index) {
+        dcfg->configvars_index =
+            modperl_table_index_make(dcfg->pool, dcfg->configvars);
+    }
+    idx = dcfg->configvars_index;
+    modperl_global_unlock(&MP_global_dir_index);
+
+    return idx;
+}
+
 typedef struct {
     AV *av;
     I32 ix;
@@ -506,6 +611,273 @@ svav_getstr(void *buf, size_t bufsiz, void *param)
 #endif
 }
 
+/*
+ * add_config() lines are normally config strings, which go through
+ * ap_build_config() just like httpd.conf does.  an array reference
+ * instead of a string is a directive already split up:
+ *
+ *   [ $directive, $args ]
+ *   [ $section, $args, [ @directives ] ] # <$section $args>...</$section>
+ *
+ * which is turned into an ap_directive_t node directly, without
+ * generating and re-parsing its text.  EXEC_ON_READ directives
+ * (<Perl>, <IfModule>, Include, ...) need to be run by the parser,
+ * so the nodes containing them, or containing plain strings, are
+ * turned back into text.
+ */
+
+#define MP_CONFIG_NODE_OK(sv)                                   \
+    (SvROK(sv) && SvTYPE(SvRV(sv)) == SVt_PVAV &&               \
+     (AvFILLp((AV *)SvRV(sv)) == 1 || AvFILLp((AV *)SvRV(sv)) == 2))
+
+#define MP_CONFIG_NODE_ELT(av, i)                               \
+    (AvFILLp(av) >= (i) && AvARRAY(av)[i] && SvOK(AvARRAY(av)[i]) \
+     ? SvPV_nolen(AvARRAY(av)[i]) : "")
+
+static AV *modperl_config_node_children(pTHX_ AV *node)
+{
+    SV *sv;
+
+    if (AvFILLp(node) < 2 || !(sv = AvARRAY(node)[2]) || !SvOK(sv)) {
+        return (AV *)NULL;
+    }
+
+    return SvROK(sv) && SvTYPE(SvRV(sv)) == SVt_PVAV ? (AV *)SvRV(sv) : NULL;
+}
+
+#define modperl_config_node_name(node) MP_CONFIG_NODE_ELT(node, 0)
+
+static int modperl_config_node_needs_text(pTHX_ SV *sv)
+{
+    AV *node = (AV *)SvRV(sv), *children;
+    const char *name = modperl_config_node_name(node);
+    module *mod = ap_top_module;
+    const command_rec *cmd;
+    char section[MAX_STRING_LEN];
+    I32 i;
+
+    if ((children = modperl_config_node_children(aTHX_ node))) {
+        apr_snprintf(section, sizeof(section), "<%s", name);
+        name = section;
+    }
+
+    cmd = ap_find_command_in_modules(name, &mod);
+
+    if (cmd && (cmd->req_override & EXEC_ON_READ)) {
+        return TRUE;
+    }
+
+    /* text lines inside a section need the parser as well */
+    for (i = 0; children && i <= AvFILLp(children); i++) {
+        SV *child = AvARRAY(children)[i];
+        if (child && (!MP_CONFIG_NODE_OK(child) ||
+                      modperl_config_node_needs_text(aTHX_ child))) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static const char *modperl_config_node_text(pTHX_ AV *text, SV *sv)
+{
+    AV *node, *children;
+    const char *name;
+    I32 i;
+
+    if (!MP_CONFIG_NODE_OK(sv)) {
+        return "a config node must be [directive, args] "
+            "or [section, args, [directives]]";
+    }
+
+    node = (AV *)SvRV(sv);
+    name = modperl_config_node_name(node);
+
+    if (!(children = modperl_config_node_children(aTHX_ node))) {
+        av_push(text, Perl_newSVpvf(aTHX_ "%s %s", name,
+                                    MP_CONFIG_NODE_ELT(node, 1)));
+        return NULL;
+    }
+
+    av_push(text, Perl_newSVpvf(aTHX_ "<%s %s>", name,
+                                MP_CONFIG_NODE_ELT(node, 1)));
+
+    for (i = 0; i <= AvFILLp(children); i++) {
+        const char *errmsg;
+        SV *child = AvARRAY(children)[i];
+        if (child && SvROK(child)) {
+            if ((errmsg = modperl_config_node_text(aTHX_ text, child))) {
+                return errmsg;
+            }
+        }
+        else if (child) {
+            av_push(text, SvREFCNT_inc(child));
+        }
+    }
+
+    av_push(text, Perl_newSVpvf(aTHX_ "</%s>", name));
+
+    return NULL;
+}
+
+static const char *modperl_config_node_build(pTHX_ cmd_parms *parms,
+                                             apr_pool_t *p, SV *sv,
+                                             ap_directive_t *parent,
+                                             ap_directive_t **nodep,
+                                             int line_num)
+{
+    AV *node, *children;
+    ap_directive_t *dir, *last = NULL;
+    const char *name, *args;
+    I32 i;
+
+    if (!MP_CONFIG_NODE_OK(sv)) {
+        return "a config node must be [directive, args] "
+            "or [section, args, [directives]]";
+    }
+
+    node = (AV *)SvRV(sv);
+    name = modperl_config_node_name(node);
+
+    if (!*name) {
+        return "a config node must have a directive name";
+    }
+
+    dir = (ap_directive_t *)apr_pcalloc(p, sizeof(*dir));
+    dir->parent   = parent;
+    dir->filename = parms->config_file->name;
+    dir->line_num = line_num;
+
+    /* ap_build_config() expands ${VAR} references on every line */
+    args = ap_resolve_env(parms->temp_pool, MP_CONFIG_NODE_ELT(node, 1));
+
+    if (!(children = modperl_config_node_children(aTHX_ node))) {
+        dir->directive = apr_pstrdup(p, name);
+        dir->args      = apr_pstrdup(p, args);
+        *nodep = dir;
+        return NULL;
+    }
+
+    /* like ap_build_config(), which leaves the '>' to the section
+     * handler to strip */
+    dir->directive = apr_pstrcat(p, "<", name, NULL);
+    dir->args      = apr_pstrcat(p, args, ">", NULL);
+
+    for (i = 0; i <= AvFILLp(children); i++) {
+        ap_directive_t *child;
+        const char *errmsg;
+
+        if (!AvARRAY(children)[i]) {
+            continue;
+        }
+
+        errmsg = modperl_config_node_build(aTHX_ parms, p,
+                                           AvARRAY(children)[i], dir,
+                                           &child, line_num);
+        if (errmsg) {
+            return errmsg;
+        }
+
+        if (last) {
+            last->next = child;
+        }
+        else {
+            dir->first_child = child;
+        }
+        last = child;
+    }
+
+    *nodep = dir;
+
+    return NULL;
+}
+
+static const char *modperl_config_build_text(pTHX_ cmd_parms *parms,
+                                             apr_pool_t *p,
+                                             svav_param_t *svav_parms,
+                                             AV *av,
+                                             ap_directive_t **conftree,
+                                             ap_directive_t **tail)
+{
+    const char *errmsg;
+
+    svav_parms->av = av;
+    svav_parms->ix = 0;
+
+    errmsg = ap_build_config(parms, p, parms->temp_pool, conftree);
+
+    if (!*tail) {
+        *tail = *conftree;
+    }
+    while (*tail && (*tail)->next) {
+        *tail = (*tail)->next;
+    }
+
+    return errmsg;
+}
+
+static const char *modperl_config_build_mixed(pTHX_ cmd_parms *parms,
+                                              apr_pool_t *p,
+                                              svav_param_t *svav_parms,
+                                              AV *lines,
+                                              ap_directive_t **conftree)
+{
+    const char *errmsg = NULL;
+    ap_directive_t *tail = NULL;
+    AV *text = newAV();
+    I32 i;
+
+    for (i = 0; i <= AvFILL(lines) && !errmsg; i++) {
+        SV *sv = AvARRAY(lines)[i];
+
+        if (!sv) {
+            continue;
+        }
+
+        if (!SvROK(sv)) {
+            av_push(text, SvREFCNT_inc(sv));
+        }
+        else if (!MP_CONFIG_NODE_OK(sv) ||
+                 modperl_config_node_needs_text(aTHX_ sv)) {
+            errmsg = modperl_config_node_text(aTHX_ text, sv);
+        }
+        else {
+            ap_directive_t *node;
+
+            if (AvFILLp(text) >= 0) {
+                errmsg = modperl_config_build_text(aTHX_ parms, p,
+                                                   svav_parms, text,
+                                                   conftree, &tail);
+                av_clear(text);
+                if (errmsg) {
+                    break;
+                }
+            }
+
+            errmsg = modperl_config_node_build(aTHX_ parms, p, sv, NULL,
+                                               &node, i + 1);
+            if (!errmsg) {
+                if (tail) {
+                    tail->next = node;
+                }
+                else {
+                    *conftree = node;
+                }
+                tail = node;
+            }
+        }
+    }
+
+    if (!errmsg && AvFILLp(text) >= 0) {
+        errmsg = modperl_config_build_text(aTHX_ parms, p, svav_parms, text,
+                                           conftree, &tail);
+    }
+
+    SvREFCNT_dec((SV *)text);
+
+    return errmsg;
+}
+
 const char *modperl_config_insert(pTHX_ server_rec *s,
                                   apr_pool_t *p,
                                   apr_pool_t *ptmp,
@@ -519,6 +891,9 @@ const char *modperl_config_insert(pTHX_ server_rec *s,
     cmd_parms parms;
     svav_param_t svav_parms;
     ap_directive_t *conftree = NULL;
+    AV *av;
+    int mixed = FALSE;
+    I32 i;
 
     memset(&parms, '\0', sizeof(parms));
 
@@ -547,7 +922,8 @@ const char *modperl_config_insert(pTHX_ server_rec *s,
         return "not an array reference";
     }
 
-    svav_parms.av = (AV*)SvRV(lines);
+    av = (AV*)SvRV(lines);
+    svav_parms.av = av;
     svav_parms.ix = 0;
 #ifdef USE_ITHREADS
     svav_parms.perl = aTHX;
@@ -557,7 +933,20 @@ const char *modperl_config_insert(pTHX_ server_rec *s,
                                             &svav_parms, NULL,
                                             svav_getstr, NULL);
 
-    errmsg = ap_build_config(&parms, p, parms.temp_pool, &conftree);
+    for (i = 0; i <= AvFILL(av); i++) {
+        if (AvARRAY(av)[i] && SvROK(AvARRAY(av)[i])) {
+            mixed = TRUE;
+            break;
+        }
+    }
+
+    if (mixed) {
+        errmsg = modperl_config_build_mixed(aTHX_ &parms, p, &svav_parms,
+                                            av, &conftree);
+    }
+    else {
+        errmsg = ap_build_config(&parms, p, parms.temp_pool, &conftree);
+    }
 
     if (!errmsg) {
         errmsg = ap_walk_config(conftree, &parms, conf);
@@ -601,6 +990,277 @@ const char *modperl_config_insert_server(pTHX_ server_rec *s, SV *lines)
                                  s->lookup_defaults, lines);
 }
 
+/*
+ * $r->add_config() tends to be called with the same lines on every
+ * request to a given url.  with PerlAddConfigCache N, the config
+ * vectors built from up to N different sets of lines in the requests
+ * to that server are kept for the server generation, so the lines are parsed and their directives run
+ * only the first time they are seen.  merges into a per_dir_config
+ * which is itself long lived (the server's lookup_defaults or an
+ * earlier cached merge) are kept as well, and like the vectors of
+ * <Location> sections they are shared by all the requests using them.
+ */
+
+typedef struct {
+    apr_pool_t *pool;
+    apr_hash_t *parsed;  /* lines -> ap_conf_vector_t * */
+    apr_hash_t *merged;  /* {base, add} -> ap_conf_vector_t * */
+    apr_hash_t *stable;  /* merged vectors usable as a base */
+    apr_hash_t *entries; /* server_rec * -> number of its entries */
+} modperl_config_insert_cache_t;
+
+typedef struct {
+    ap_conf_vector_t *base;
+    ap_conf_vector_t *add;
+} modperl_config_insert_merge_key_t;
+
+static modperl_global_t MP_global_config_insert;
+
+void modperl_config_insert_cache_init(apr_pool_t *p)
+{
+    modperl_config_insert_cache_t *cache =
+        (modperl_config_insert_cache_t *)apr_pcalloc(p, sizeof(*cache));
+    apr_allocator_t *allocator;
+
+    /* the cache is filled at request time from any thread, so it gets
+     * its own allocator, whose mutex also guards its subpool list */
+    apr_allocator_create(&allocator);
+    apr_pool_create_ex(&cache->pool, p, NULL, allocator);
+    apr_allocator_owner_set(allocator, cache->pool);
+#if APR_HAS_THREADS
+    {
+        apr_thread_mutex_t *mutex;
+        apr_thread_mutex_create(&mutex, APR_THREAD_MUTEX_DEFAULT,
+                                cache->pool);
+        apr_allocator_mutex_set(allocator, mutex);
+    }
+#endif
+
+    cache->parsed = apr_hash_make(cache->pool);
+    cache->merged = apr_hash_make(cache->pool);
+    cache->stable = apr_hash_make(cache->pool);
+    cache->entries = apr_hash_make(cache->pool);
+
+    modperl_global_init(&MP_global_config_insert, p, (void *)cache,
+                        "config_insert");
+}
+
+/* the count of the entries cached for s, called with the lock held */
+static int *modperl_config_insert_cache_entries(modperl_config_insert_cache_t
+                                                *cache, server_rec *s)
+{
+    int *entries = (int *)apr_hash_get(cache->entries, &s, sizeof(s));
+
+    if (!entries) {
+        server_rec **key =
+            (server_rec **)apr_pmemdup(cache->pool, &s, sizeof(s));
+        entries = (int *)apr_pcalloc(cache->pool, sizeof(*entries));
+        apr_hash_set(cache->entries, key, sizeof(*key), entries);
+    }
+
+    return entries;
+}
+
+/* the cache key of lines given as plain strings, NULL for anything
+ * else, which isn't cached */
+static const char *modperl_config_insert_cache_key(pTHX_ request_rec *r,
+                                                   SV *lines,
+                                                   int override,
+                                                   const char *path,
+                                                   int override_options)
+{
+    struct iovec *vec;
+    AV *av;
+    I32 i;
+    int n = 0;
+
+    if (!(SvROK(lines) && (SvTYPE(SvRV(lines)) == SVt_PVAV))) {
+        return NULL;
+    }
+
+    av = (AV *)SvRV(lines);
+    vec = (struct iovec *)apr_palloc(r->pool,
+                                     (AvFILL(av) + 2) * 2 * sizeof(*vec));
+
+    vec[n].iov_base = apr_psprintf(r->pool, "%pp %d %d %s",
+                                   (void *)r->server, override,
+                                   override_options, path);
+    vec[n].iov_len = strlen(vec[n].iov_base);
+    n++;
+
+    for (i = 0; i <= AvFILL(av); i++) {
+        SV *sv = AvARRAY(av)[i];
+        STRLEN len;
+
+        if (!sv || SvROK(sv)) {
+            return NULL;
+        }
+
+        vec[n].iov_base = (char *)"\n";
+        vec[n].iov_len = 1;
+        n++;
+        vec[n].iov_base = SvPV(sv, len);
+        vec[n].iov_len = len;
+        n++;
+    }
+
+    return apr_pstrcatv(r->pool, vec, n, NULL);
+}
+
+#ifdef USE_ITHREADS
+/* config objects of Perl directive handlers live in the interpreter
+ * which ran them, so a vector holding some can't be handed to the
+ * other interpreters */
+static int modperl_config_insert_cacheable(request_rec *r,
+                                           ap_conf_vector_t *dconf)
+{
+    MP_dSCFG(r->server);
+    apr_hash_index_t *hi;
+
+    if (!scfg->modules) {
+        return TRUE;
+    }
+
+    for (hi = apr_hash_first(r->pool, scfg->modules); hi;
+         hi = apr_hash_next(hi)) {
+        void *val;
+        apr_hash_this(hi, NULL, NULL, &val);
+        if (ap_get_module_config(dconf, (module *)val)) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+#else
+#define modperl_config_insert_cacheable(r, dconf) TRUE
+#endif
+
+static apr_status_t modperl_config_insert_pool_destroy(void *data)
+{
+    apr_pool_destroy((apr_pool_t *)data);
+    return APR_SUCCESS;
+}
+
+static const char *modperl_config_insert_cached(pTHX_
+                                                request_rec *r,
+                                                SV *lines,
+                                                int override,
+                                                char *path,
+                                                int override_options,
+                                                const char *key)
+{
+    modperl_config_insert_cache_t *cache;
+    modperl_config_insert_merge_key_t mkey;
+    ap_conf_vector_t *dconf, *merged = NULL, *base = r->per_dir_config;
+    apr_pool_t *p;
+    const char *errmsg;
+    int stable, room, *entries;
+    MP_dSCFG(r->server);
+
+    modperl_global_lock(&MP_global_config_insert);
+    cache = (modperl_config_insert_cache_t *)
+        modperl_global_get(&MP_global_config_insert);
+    dconf = (ap_conf_vector_t *)apr_hash_get(cache->parsed, key,
+                                             APR_HASH_KEY_STRING);
+    modperl_global_unlock(&MP_global_config_insert);
+
+    if (!dconf) {
+        apr_pool_create(&p, cache->pool);
+        dconf = ap_create_per_dir_config(p);
+
+        errmsg = modperl_config_insert(aTHX_
+                                       r->server, p, r->pool,
+                                       override, path, override_options,
+                                       dconf, lines);
+
+        if (errmsg) {
+            apr_pool_destroy(p);
+            return errmsg;
+        }
+
+        modperl_global_lock(&MP_global_config_insert);
+        entries = modperl_config_insert_cache_entries(cache, r->server);
+        room = *entries < scfg->add_config_cache &&
+            !apr_hash_get(cache->parsed, key, APR_HASH_KEY_STRING) &&
+            modperl_config_insert_cacheable(r, dconf);
+        if (room) {
+            apr_hash_set(cache->parsed, apr_pstrdup(p, key),
+                         APR_HASH_KEY_STRING, dconf);
+            (*entries)++;
+        }
+        modperl_global_unlock(&MP_global_config_insert);
+
+        if (!room) {
+            /* used by this request only */
+            apr_pool_cleanup_register(r->pool, (void *)p,
+                                      modperl_config_insert_pool_destroy,
+                                      apr_pool_cleanup_null);
+            r->per_dir_config =
+                ap_merge_per_dir_configs(r->pool, base, dconf);
+            return NULL;
+        }
+
+        MP_TRACE_d(MP_FUNC, "cached the add_config vector 0x%lx",
+                   (unsigned long)dconf);
+    }
+
+    memset(&mkey, 0, sizeof(mkey));
+    mkey.base = base;
+    mkey.add  = dconf;
+
+    modperl_global_lock(&MP_global_config_insert);
+    stable = base == r->server->lookup_defaults ||
+        apr_hash_get(cache->stable, &base, sizeof(base));
+    if (stable) {
+        merged = (ap_conf_vector_t *)apr_hash_get(cache->merged,
+                                                  &mkey, sizeof(mkey));
+    }
+    entries = modperl_config_insert_cache_entries(cache, r->server);
+    room = *entries < scfg->add_config_cache;
+    modperl_global_unlock(&MP_global_config_insert);
+
+    if (merged) {
+        r->per_dir_config = merged;
+        return NULL;
+    }
+
+    if (!(stable && room)) {
+        r->per_dir_config = ap_merge_per_dir_configs(r->pool, base, dconf);
+        return NULL;
+    }
+
+    apr_pool_create(&p, cache->pool);
+    merged = ap_merge_per_dir_configs(p, base, dconf);
+
+    modperl_global_lock(&MP_global_config_insert);
+    if (apr_hash_get(cache->merged, &mkey, sizeof(mkey))) {
+        /* another thread got there first, keep using ours */
+        room = FALSE;
+    }
+    else {
+        modperl_config_insert_merge_key_t *mk =
+            (modperl_config_insert_merge_key_t *)apr_pmemdup(p, &mkey,
+                                                             sizeof(mkey));
+        ap_conf_vector_t **mp =
+            (ap_conf_vector_t **)apr_pmemdup(p, &merged, sizeof(merged));
+        apr_hash_set(cache->merged, mk, sizeof(*mk), merged);
+        apr_hash_set(cache->stable, mp, sizeof(*mp), merged);
+        (*entries)++;
+    }
+    modperl_global_unlock(&MP_global_config_insert);
+
+    if (!room) {
+        apr_pool_cleanup_register(r->pool, (void *)p,
+                                  modperl_config_insert_pool_destroy,
+                                  apr_pool_cleanup_null);
+    }
+
+    r->per_dir_config = merged;
+
+    return NULL;
+}
+
 const char *modperl_config_insert_request(pTHX_
                                           request_rec *r,
                                           SV *lines,
@@ -608,14 +1268,24 @@ const char *modperl_config_insert_request(pTHX_
                                           char *path,
                                           int override_options)
 {
-    const char *errmsg;
-    ap_conf_vector_t *dconf = ap_create_per_dir_config(r->pool);
+    const char *errmsg, *key;
+    ap_conf_vector_t *dconf;
+    MP_dSCFG(r->server);
 
     if (!path) {
         /* pass a non-NULL path if nothing else given and for compatibility */
         path = "/";
     }
 
+    if (scfg->add_config_cache &&
+        (key = modperl_config_insert_cache_key(aTHX_ r, lines, override,
+                                               path, override_options))) {
+        return modperl_config_insert_cached(aTHX_ r, lines, override, path,
+                                            override_options, key);
+    }
+
+    dconf = ap_create_per_dir_config(r->pool);
+
     errmsg = modperl_config_insert(aTHX_
                                    r->server, r->pool, r->pool,
                                    override, path, override_options,
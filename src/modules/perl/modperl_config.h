@@ -130,6 +130,17 @@ int modperl_config_apply_PerlPostConfigRequire(server_rec *s,
                                                modperl_config_srv_t *scfg,
                                                apr_pool_t *p);
 
+int modperl_config_apply_PerlWarmupHandler(server_rec *s,
+                                           modperl_config_srv_t *scfg,
+                                           apr_pool_t *p);
+
+void modperl_config_configvars_index(server_rec *s, apr_pool_t *p);
+
+void modperl_config_dir_index_init(apr_pool_t *p);
+
+modperl_table_index_t *
+modperl_config_dir_index_get(modperl_config_dir_t *dcfg);
+
 const char *modperl_config_insert(pTHX_ server_rec *s,
                                   apr_pool_t *p,
                                   apr_pool_t *ptmp,
@@ -151,6 +162,8 @@ const char *modperl_config_insert_request(pTHX_
                                           char *path,
                                           int override_options);
 
+void modperl_config_insert_cache_init(apr_pool_t *p);
+
 int modperl_config_is_perl_option_enabled(pTHX_ request_rec *r,
                                           server_rec *s, const char *name);
 
@@ -350,6 +350,7 @@ void modperl_env_default_populate(pTHX)
 void modperl_env_request_populate(pTHX_ request_rec *r)
 {
     MP_dRCFG;
+    apr_time_t env_start = modperl_timeline_now(r);
 
     /* this is called under the following conditions
      *   - if PerlOptions +SetupEnv
@@ -387,6 +388,8 @@ void modperl_env_request_populate(pTHX_ request_rec *r)
      * resets %ENV between requests - see modperl_config_request_cleanup
      */
     MpReqSETUP_ENV_On(rcfg);
+
+    modperl_timeline_add(r, "env", NULL, env_start);
 }
 
 void modperl_env_request_unpopulate(pTHX_ request_rec *r)
@@ -233,6 +233,7 @@ MP_INLINE apr_status_t modperl_wbucket_flush(modperl_wbucket_t *wb,
                                              int add_flush_bucket)
 {
     apr_status_t rv = APR_SUCCESS;
+    apr_time_t flush_start = modperl_timeline_now(wb->r);
 
     if (wb->outcnt) {
         rv = modperl_wbucket_pass(wb, wb->outbuf, wb->outcnt,
@@ -242,6 +243,8 @@ MP_INLINE apr_status_t modperl_wbucket_flush(modperl_wbucket_t *wb,
         rv = send_output_flush(*(wb->filters));
     }
 
+    modperl_timeline_add(wb->r, "flush", NULL, flush_start);
+
     return rv;
 }
 
@@ -485,6 +488,7 @@ int modperl_run_filter(modperl_filter_t *filter)
     conn_rec    *c = filter->f->c;
     server_rec  *s = r ? r->server : c->base_server;
     apr_pool_t  *p = r ? r->pool : c->pool;
+    apr_time_t filter_start = modperl_timeline_now(r);
 
     MP_dINTERPa(r, c, s);
 
@@ -558,6 +562,9 @@ int modperl_run_filter(modperl_filter_t *filter)
 
     MP_INTERP_PUTBACK(interp, aTHX);
 
+    modperl_timeline_add(r, "filter", modperl_handler_name(handler),
+                         filter_start);
+
     MP_TRACE_f(MP_FUNC, MP_FILTER_NAME_FORMAT
                "return: %d", modperl_handler_name(handler), status);
 
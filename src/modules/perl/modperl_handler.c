@@ -227,12 +227,22 @@ int modperl_handler_resolve(pTHX_ modperl_handler_t **handp,
                    duped ? "current" : "server conf",
                    (unsigned long)rp);
 
+#ifdef USE_ITHREADS
+        if (modperl_mgv_cache_get(aTHX_ handler, s)) {
+            return OK;
+        }
+#endif
+
         if (!modperl_mgv_resolve(aTHX_ handler, rp, handler->name, FALSE)) {
             modperl_errsv_prepend(aTHX_
                                   "failed to resolve handler `%s': ",
                                   handler->name);
             return HTTP_INTERNAL_SERVER_ERROR;
         }
+
+#ifdef USE_ITHREADS
+        modperl_mgv_cache_set(handler, s);
+#endif
     }
 
     return OK;
@@ -294,7 +304,7 @@ void modperl_handler_make_args(pTHX_ AV **avp, ...)
     va_list args;
 
     if (!*avp) {
-        *avp = newAV(); /* XXX: cache an intialized AV* per-request */
+        *avp = modperl_arena_av(aTHX);
     }
 
     va_start(args, avp);
@@ -332,7 +342,7 @@ void modperl_handler_make_args(pTHX_ AV **avp, ...)
                 break;
             }
           default:
-            sv = modperl_ptr2obj(aTHX_ classname, ptr);
+            sv = modperl_arena_ptr2obj(aTHX_ classname, ptr);
             break;
         }
 
@@ -75,6 +75,7 @@ modperl_interp_t *modperl_interp_new(modperl_interp_pool_t *mip,
                                                              source);
 
                 modperl_module_config_table_set(interp->perl, table);
+                interp->config_table = table;
             }
         }
 
@@ -394,6 +395,7 @@ modperl_interp_t *modperl_interp_select(request_rec *r, conn_rec *c,
     const char *desc = NULL;
     modperl_interp_t *interp = NULL;
     apr_pool_t *p = NULL;
+    apr_time_t wait_start;
 
     /* What does the following condition mean?
      * (r || c): if true we are at runtime. There is some kind of request
@@ -437,7 +439,9 @@ modperl_interp_t *modperl_interp_select(request_rec *r, conn_rec *c,
 
     MP_TRACE_i(MP_FUNC,
                "fetching interp for %s:%d", s->server_hostname, s->port);
+    wait_start = modperl_timeline_now(r);
     interp = modperl_interp_get(s);
+    modperl_timeline_add(r, "interp", NULL, wait_start);
     MP_TRACE_i(MP_FUNC, "  --> got %pp (perl=%pp)", interp, interp->perl);
     ++interp->num_requests; /* should only get here once per request */
     interp->refcnt = 1;
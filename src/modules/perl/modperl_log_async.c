@@ -0,0 +1,343 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+
+#if AP_SERVER_MAJORVERSION_NUMBER>2 || \
+    (AP_SERVER_MAJORVERSION_NUMBER == 2 && AP_SERVER_MINORVERSION_NUMBER>=3)
+#define MP_LOG_CLIENT_IP(r) (r)->useragent_ip
+#else
+#define MP_LOG_CLIENT_IP(r) (r)->connection->remote_ip
+#endif
+
+typedef struct {
+    server_rec *s;
+    int level;
+    int line;
+    const char *file; /* NULL, or in buf after the message */
+    char buf[1];      /* the message */
+} modperl_log_async_rec_t;
+
+typedef struct {
+#if APR_HAS_THREADS
+    apr_thread_mutex_t *mutex;
+    apr_thread_cond_t *cond;
+    apr_thread_cond_t *drained; /* signaled after each batch */
+    apr_thread_t *thread;
+#endif
+    modperl_log_async_rec_t **ring;
+    int size;
+    int head;
+    int nelts;
+    int busy; /* a batch is being written */
+    int stop;
+    apr_uint32_t queued;
+    apr_uint32_t dropped;
+    apr_uint32_t written;
+    apr_uint32_t batches;
+} modperl_log_async_t;
+
+/* the ring size configured by PerlLogAsync, 0 == disabled */
+static int MP_log_async_size = 0;
+
+/* the running writer, set in the child processes only */
+static modperl_log_async_t *MP_log_async = NULL;
+
+void modperl_log_async_init(apr_pool_t *p)
+{
+    /* re-read on restart */
+    MP_log_async_size = 0;
+}
+
+const char *modperl_log_async_size_set(const char *arg)
+{
+    MP_log_async_size = atoi(arg);
+
+    if (MP_log_async_size < 0) {
+        return "PerlLogAsync: the ring size must be a positive number";
+    }
+
+#if !APR_HAS_THREADS
+    if (MP_log_async_size) {
+        return "PerlLogAsync requires APR built with threads";
+    }
+#endif
+
+    return NULL;
+}
+
+int modperl_log_is_level(server_rec *s, request_rec *r, int level)
+{
+    level &= APLOG_LEVELMASK;
+
+#if AP_SERVER_MAJORVERSION_NUMBER>2 || \
+    (AP_SERVER_MAJORVERSION_NUMBER == 2 && AP_SERVER_MINORVERSION_NUMBER>=3)
+    if (r) {
+        return APLOG_R_MODULE_IS_LEVEL(r, perl_module.module_index, level);
+    }
+    return APLOG_MODULE_IS_LEVEL(s, perl_module.module_index, level);
+#else
+    /* httpd 2.2 logs notice messages regardless of LogLevel */
+    return level == APLOG_NOTICE || level <= mp_loglevel(s);
+#endif
+}
+
+#if APR_HAS_THREADS
+
+/* the records go through ap_log_error(), so ErrorLogFormat, the
+ * piped and syslog loggers and the error_log hooks all apply.  the
+ * request is gone by now, so its client address is part of the
+ * message, see modperl_log_async() */
+static void modperl_log_async_write(modperl_log_async_rec_t **recs, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        ap_log_error(recs[i]->file, recs[i]->line,
+                     mp_module_index_ recs[i]->level, 0, recs[i]->s,
+                     "%s", recs[i]->buf);
+    }
+}
+
+static void * APR_THREAD_FUNC modperl_log_async_run(apr_thread_t *thread,
+                                                    void *data)
+{
+    modperl_log_async_t *la = (modperl_log_async_t *)data;
+    modperl_log_async_rec_t **batch;
+    int i, n;
+
+    batch = (modperl_log_async_rec_t **)
+        malloc(sizeof(*batch) * la->size);
+
+    for (;;) {
+        apr_thread_mutex_lock(la->mutex);
+        while (!la->nelts && !la->stop) {
+            apr_thread_cond_wait(la->cond, la->mutex);
+        }
+        for (n = 0; la->nelts; la->nelts--, n++) {
+            batch[n] = la->ring[la->head];
+            la->head = (la->head + 1) % la->size;
+        }
+        if (!n && la->stop) {
+            apr_thread_mutex_unlock(la->mutex);
+            break;
+        }
+        la->busy = 1;
+        apr_thread_mutex_unlock(la->mutex);
+
+        modperl_log_async_write(batch, n);
+
+        for (i = 0; i < n; i++) {
+            free(batch[i]);
+        }
+        apr_atomic_add32(&la->written, n);
+        apr_atomic_inc32(&la->batches);
+
+        apr_thread_mutex_lock(la->mutex);
+        la->busy = 0;
+        apr_thread_cond_broadcast(la->drained);
+        apr_thread_mutex_unlock(la->mutex);
+    }
+
+    free(batch);
+    apr_thread_exit(thread, APR_SUCCESS);
+
+    return NULL;
+}
+
+static apr_status_t modperl_log_async_stop(void *data)
+{
+    modperl_log_async_t *la = (modperl_log_async_t *)data;
+    apr_status_t rv;
+
+    /* log synchronously from now on */
+    MP_log_async = NULL;
+
+    apr_thread_mutex_lock(la->mutex);
+    la->stop = 1;
+    apr_thread_cond_signal(la->cond);
+    apr_thread_mutex_unlock(la->mutex);
+
+    /* the writer drains the ring before it exits */
+    apr_thread_join(&rv, la->thread);
+
+    free(la->ring);
+
+    return APR_SUCCESS;
+}
+
+void modperl_log_async_child_init(apr_pool_t *p, server_rec *s)
+{
+    modperl_log_async_t *la;
+    apr_status_t rv;
+
+    if (!MP_log_async_size) {
+        return;
+    }
+
+    la = (modperl_log_async_t *)apr_pcalloc(p, sizeof(*la));
+    la->size = MP_log_async_size;
+    la->ring = (modperl_log_async_rec_t **)
+        calloc(la->size, sizeof(*la->ring));
+
+    if ((rv = apr_thread_mutex_create(&la->mutex,
+                                      APR_THREAD_MUTEX_DEFAULT, p))
+        != APR_SUCCESS ||
+        (rv = apr_thread_cond_create(&la->cond, p)) != APR_SUCCESS ||
+        (rv = apr_thread_cond_create(&la->drained, p)) != APR_SUCCESS ||
+        (rv = apr_thread_create(&la->thread, NULL, modperl_log_async_run,
+                                (void *)la, p)) != APR_SUCCESS) {
+        ap_log_error(APLOG_MARK, APLOG_ERR, rv, s,
+                     "PerlLogAsync: failed to start the writer thread, "
+                     "logging synchronously");
+        free(la->ring);
+        return;
+    }
+
+    /* registered after the mutex/cond cleanups, so it runs first */
+    apr_pool_cleanup_register(p, (void *)la, modperl_log_async_stop,
+                              apr_pool_cleanup_null);
+
+    MP_log_async = la;
+}
+
+/* returns TRUE if the message was queued (or dropped), FALSE if the
+ * caller should log it synchronously. the caller has already checked
+ * modperl_log_is_level() for r */
+int modperl_log_async(server_rec *s, request_rec *r,
+                      const char *file, int line, int level,
+                      const char *msg)
+{
+    modperl_log_async_t *la = MP_log_async;
+    modperl_log_async_rec_t *rec;
+    const char *client = r ? MP_LOG_CLIENT_IP(r) : NULL;
+    apr_size_t prefix = client ? strlen(client) + 10 : 0;
+    apr_size_t len = strlen(msg);
+    apr_size_t flen = file ? strlen(file) + 1 : 0;
+    int queued = 0;
+
+    if (!la) {
+        return FALSE;
+    }
+
+    /* the writer logs without the request, so ap_log_error() would
+     * drop a message enabled only by the request's (per-dir) LogLevel:
+     * log those synchronously */
+    if (r && !modperl_log_is_level(s, NULL, level)) {
+        return FALSE;
+    }
+
+    /* "[client ip] msg\0file\0", the file belongs to perl code which
+     * may be gone by the time the record is written */
+    rec = (modperl_log_async_rec_t *)
+        malloc(sizeof(*rec) + prefix + len + flen);
+    if (!rec) {
+        return FALSE;
+    }
+    rec->s = s;
+    rec->level = level;
+    rec->line = line;
+    if (client) {
+        prefix = apr_snprintf(rec->buf, prefix + 1, "[client %s] ", client);
+    }
+    memcpy(rec->buf + prefix, msg, len + 1);
+    if (file) {
+        rec->file = rec->buf + prefix + len + 1;
+        memcpy((char *)rec->file, file, flen);
+    }
+    else {
+        rec->file = NULL;
+    }
+
+    apr_thread_mutex_lock(la->mutex);
+    if (la->nelts < la->size && !la->stop) {
+        la->ring[(la->head + la->nelts) % la->size] = rec;
+        if (!la->nelts++) {
+            apr_thread_cond_signal(la->cond);
+        }
+        queued = 1;
+    }
+    apr_thread_mutex_unlock(la->mutex);
+
+    if (queued) {
+        apr_atomic_inc32(&la->queued);
+    }
+    else {
+        apr_atomic_inc32(&la->dropped);
+        free(rec);
+    }
+
+    return TRUE;
+}
+
+void modperl_log_async_flush(void)
+{
+    modperl_log_async_t *la = MP_log_async;
+
+    if (!la) {
+        return;
+    }
+
+    apr_thread_mutex_lock(la->mutex);
+    while ((la->nelts || la->busy) && !la->stop) {
+        apr_thread_cond_wait(la->drained, la->mutex);
+    }
+    apr_thread_mutex_unlock(la->mutex);
+}
+
+#else /* !APR_HAS_THREADS */
+
+void modperl_log_async_child_init(apr_pool_t *p, server_rec *s)
+{
+}
+
+int modperl_log_async(server_rec *s, request_rec *r,
+                      const char *file, int line, int level,
+                      const char *msg)
+{
+    return FALSE;
+}
+
+void modperl_log_async_flush(void)
+{
+}
+
+#endif /* APR_HAS_THREADS */
+
+#define MP_LOG_ASYNC_STATS_STORE(hv, la, field)                       \
+    (void)hv_store(hv, #field, sizeof(#field) - 1,                      \
+                   newSVuv(la ? apr_atomic_read32(&la->field) : 0), 0)
+
+SV *modperl_log_async_stats(pTHX)
+{
+    HV *hv = newHV();
+    modperl_log_async_t *la = MP_log_async;
+
+    (void)hv_store(hv, "size", 4, newSViv(la ? la->size : 0), 0);
+    MP_LOG_ASYNC_STATS_STORE(hv, la, queued);
+    MP_LOG_ASYNC_STATS_STORE(hv, la, dropped);
+    MP_LOG_ASYNC_STATS_STORE(hv, la, written);
+    MP_LOG_ASYNC_STATS_STORE(hv, la, batches);
+
+    return newRV_noinc((SV *)hv);
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,56 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODPERL_LOG_ASYNC_H
+#define MODPERL_LOG_ASYNC_H
+
+/*
+ * with PerlLogAsync N, Apache2::Log messages which pass the level
+ * filter are queued in a per-process ring of N records, which a
+ * writer thread drains, handing them to ap_log_error() (so
+ * ErrorLogFormat, piped and syslog loggers and the error_log hooks
+ * still apply, but without the request: its client address is added
+ * to the message; messages enabled only by the request's per-dir
+ * LogLevel are logged synchronously).  records which don't fit into a
+ * full ring are dropped and counted, see Apache2::Log::async_stats().
+ * Apache2::Log::async_flush() waits until the queued records are
+ * written
+ */
+
+void modperl_log_async_init(apr_pool_t *p);
+
+const char *modperl_log_async_size_set(const char *arg);
+
+void modperl_log_async_child_init(apr_pool_t *p, server_rec *s);
+
+int modperl_log_is_level(server_rec *s, request_rec *r, int level);
+
+int modperl_log_async(server_rec *s, request_rec *r,
+                      const char *file, int line, int level,
+                      const char *msg);
+
+void modperl_log_async_flush(void);
+
+SV *modperl_log_async_stats(pTHX);
+
+#endif /* MODPERL_LOG_ASYNC_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
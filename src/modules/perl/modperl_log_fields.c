@@ -0,0 +1,200 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+
+typedef enum {
+    MP_LOG_FIELD_NULL,
+    MP_LOG_FIELD_IV,
+    MP_LOG_FIELD_UV,
+    MP_LOG_FIELD_NV,
+    MP_LOG_FIELD_STR
+} modperl_log_field_type_e;
+
+typedef struct {
+    const char *key;
+    modperl_log_field_type_e type;
+    union {
+        IV iv;
+        UV uv;
+        NV nv;
+        const char *str;
+    } val;
+} modperl_log_field_t;
+
+/* subrequests and internal redirects add their fields to the initial
+ * request, which is the one we find at the log phase.  a request
+ * mod_perl hasn't seen has no config, in which case we stop at the
+ * last one which has.  *owner (unless NULL) is set to the request
+ * whose config is returned: the fields must be allocated from its
+ * pool, since a subrequest's pool is gone before the log phase */
+static modperl_config_req_t *modperl_log_fields_rcfg(request_rec *r,
+                                                     request_rec **owner)
+{
+    modperl_config_req_t *rcfg = modperl_config_req_get(r);
+
+    if (owner) {
+        *owner = r;
+    }
+
+    while (rcfg && (r->main || r->prev)) {
+        modperl_config_req_t *up;
+
+        r = r->main ? r->main : r->prev;
+        if (!(up = modperl_config_req_get(r))) {
+            break;
+        }
+        rcfg = up;
+        if (owner) {
+            *owner = r;
+        }
+    }
+
+    return rcfg;
+}
+
+void modperl_log_field_set(pTHX_ request_rec *r, const char *key, SV *sv)
+{
+    request_rec *owner;
+    modperl_config_req_t *rcfg = modperl_log_fields_rcfg(r, &owner);
+    apr_pool_t *p = owner->pool;
+    modperl_log_field_t *fields, *field = NULL;
+    int i;
+
+    if (!rcfg) {
+        return;
+    }
+
+    if (!rcfg->log_fields) {
+        rcfg->log_fields =
+            apr_array_make(p, 8, sizeof(modperl_log_field_t));
+    }
+
+    /* the last value set for a key wins */
+    fields = (modperl_log_field_t *)rcfg->log_fields->elts;
+    for (i = 0; i < rcfg->log_fields->nelts; i++) {
+        if (strEQ(fields[i].key, key)) {
+            field = &fields[i];
+            break;
+        }
+    }
+    if (!field) {
+        field = (modperl_log_field_t *)apr_array_push(rcfg->log_fields);
+        field->key = apr_pstrdup(p, key);
+    }
+
+    /* keep the type the value was created with, strings stay strings
+     * even if they look like numbers */
+    if (!SvOK(sv)) {
+        field->type = MP_LOG_FIELD_NULL;
+    }
+    else if (SvPOK(sv) || SvROK(sv)) {
+        STRLEN len;
+        const char *str = SvPV(sv, len);
+        field->type = MP_LOG_FIELD_STR;
+        field->val.str = apr_pstrmemdup(p, str, len);
+    }
+    else if (SvIOK(sv)) {
+        if (SvIsUV(sv)) {
+            field->type = MP_LOG_FIELD_UV;
+            field->val.uv = SvUVX(sv);
+        }
+        else {
+            field->type = MP_LOG_FIELD_IV;
+            field->val.iv = SvIVX(sv);
+        }
+    }
+    else {
+        field->type = MP_LOG_FIELD_NV;
+        field->val.nv = SvNV(sv);
+    }
+}
+
+const char *modperl_log_fields_json(request_rec *r)
+{
+    modperl_config_req_t *rcfg = modperl_log_fields_rcfg(r, NULL);
+    apr_array_header_t *json;
+    modperl_log_field_t *fields;
+    int i;
+
+    if (!(rcfg && rcfg->log_fields && rcfg->log_fields->nelts)) {
+        return NULL;
+    }
+
+    json = apr_array_make(r->pool, rcfg->log_fields->nelts * 2 + 1,
+                          sizeof(char *));
+    fields = (modperl_log_field_t *)rcfg->log_fields->elts;
+
+    for (i = 0; i < rcfg->log_fields->nelts; i++) {
+        const char *val;
+
+        switch (fields[i].type) {
+          case MP_LOG_FIELD_IV:
+            val = apr_psprintf(r->pool, "%" IVdf, fields[i].val.iv);
+            break;
+          case MP_LOG_FIELD_UV:
+            val = apr_psprintf(r->pool, "%" UVuf, fields[i].val.uv);
+            break;
+          case MP_LOG_FIELD_NV:
+            /* JSON has no NaN/Inf */
+            val = Perl_isnan(fields[i].val.nv) || Perl_isinf(fields[i].val.nv)
+                ? "null"
+                : apr_psprintf(r->pool, "%.15g", (double)fields[i].val.nv);
+            break;
+          case MP_LOG_FIELD_STR:
+            val = modperl_json_str(r->pool, fields[i].val.str);
+            break;
+          default:
+            val = "null";
+            break;
+        }
+
+        *(const char **)apr_array_push(json) =
+            apr_pstrcat(r->pool, i ? "," : "{",
+                        modperl_json_str(r->pool, fields[i].key), ":",
+                        NULL);
+        *(const char **)apr_array_push(json) = val;
+    }
+
+    *(const char **)apr_array_push(json) = "}";
+
+    return apr_array_pstrcat(r->pool, json, '\0');
+}
+
+int modperl_log_fields_emit(request_rec *r)
+{
+    const char *json = modperl_log_fields_json(r);
+
+    if (!json) {
+        return DECLINED;
+    }
+
+    apr_table_setn(r->notes, MP_LOG_FIELDS_NOTE, json);
+
+    if (modperl_log_is_level(r->server, r, APLOG_INFO) &&
+        !modperl_log_async(r->server, r, NULL, 0, APLOG_INFO, json)) {
+        ap_log_rerror(APLOG_MARK, APLOG_INFO, 0, r, "%s", json);
+    }
+
+    return DECLINED;
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
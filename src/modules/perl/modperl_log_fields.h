@@ -0,0 +1,45 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODPERL_LOG_FIELDS_H
+#define MODPERL_LOG_FIELDS_H
+
+/*
+ * structured per-request log fields: $r->log->field(key => $val)
+ * stores typed values (null, integer, number or string) in the
+ * request config, which are emitted once, at the beginning of the
+ * log phase, as a JSON object: in the "mod_perl_log_fields" note,
+ * for mod_log_config's %{mod_perl_log_fields}n, and in the error
+ * log (via PerlLogAsync if enabled) if perl's log level is info or
+ * higher
+ */
+
+#define MP_LOG_FIELDS_NOTE "mod_perl_log_fields"
+
+void modperl_log_field_set(pTHX_ request_rec *r, const char *key, SV *sv);
+
+const char *modperl_log_fields_json(request_rec *r);
+
+int modperl_log_fields_emit(request_rec *r);
+
+#endif /* MODPERL_LOG_FIELDS_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -172,6 +172,137 @@ MP_INLINE GV *modperl_mgv_lookup_autoload(pTHX_ modperl_mgv_t *symbol,
 }
 #endif
 
+#ifdef USE_ITHREADS
+
+/*
+ * resolved handlers cache
+ *
+ * modperl_mgv_t symbols are plain C data, so once a handler name was
+ * resolved (by the parent at post_config or by any clone at request
+ * time) the result can be handed to every interpreter cloned from the
+ * same parent, including the ones cloned after PerlInterpMaxRequests
+ * has retired their predecessors.  this saves the stash and @ISA
+ * walks done by modperl_mgv_resolve() on each request for handlers
+ * which can't be resolved in place under threaded mpms.  entries are
+ * kept per interpreter pool, since vhosts with PerlOptions +Parent
+ * may resolve the same name differently.
+ */
+
+static modperl_global_t MP_global_mgv_cache;
+
+void modperl_mgv_cache_init(apr_pool_t *p)
+{
+    apr_pool_t *cache_pool;
+
+    (void)apr_pool_create(&cache_pool, p);
+    modperl_global_init(&MP_global_mgv_cache, p,
+                        (void *)cache_pool, "mgv_cache");
+}
+
+static modperl_mgv_t *modperl_mgv_dup(apr_pool_t *p, modperl_mgv_t *symbol)
+{
+    modperl_mgv_t *copy = (modperl_mgv_t *)NULL;
+    modperl_mgv_t **next = &copy;
+
+    for (; symbol; symbol = symbol->next) {
+        modperl_mgv_t *mgv = modperl_mgv_new(p);
+        mgv->name = apr_pstrmemdup(p, symbol->name, symbol->len);
+        mgv->len  = symbol->len;
+        mgv->hash = symbol->hash;
+        *next = mgv;
+        next = &mgv->next;
+    }
+
+    return copy;
+}
+
+/* anon subs, $obj->method handlers and handlers with filter init
+ * handlers attached are resolved against per-interpreter data */
+#define modperl_mgv_cacheable(handler)                                 \
+    (handler->name && handler->mgv_cv && MpHandlerPARSED(handler) &&   \
+     !(MpHandlerANON(handler) || MpHandlerOBJECT(handler) ||           \
+       handler->next))
+
+void modperl_mgv_cache_set(modperl_handler_t *handler, server_rec *s)
+{
+    MP_dSCFG(s);
+    modperl_interp_pool_t *mip = scfg->mip;
+    apr_pool_t *p;
+
+    if (!(mip && modperl_mgv_cacheable(handler))) {
+        return;
+    }
+
+    modperl_global_lock(&MP_global_mgv_cache);
+
+    p = (apr_pool_t *)modperl_global_get(&MP_global_mgv_cache);
+
+    if (!mip->mgv_cache) {
+        mip->mgv_cache = apr_hash_make(p);
+    }
+
+    if (!apr_hash_get(mip->mgv_cache, handler->name, APR_HASH_KEY_STRING)) {
+        modperl_handler_t *entry =
+            (modperl_handler_t *)apr_pcalloc(p, sizeof(*entry));
+
+        entry->name    = apr_pstrdup(p, handler->name);
+        entry->mgv_cv  = modperl_mgv_dup(p, handler->mgv_cv);
+        entry->mgv_obj = modperl_mgv_dup(p, handler->mgv_obj);
+        entry->attrs   = handler->attrs;
+        entry->flags   = handler->flags &
+            (MpHandler_f_PARSED|MpHandler_f_METHOD);
+
+        apr_hash_set(mip->mgv_cache, entry->name,
+                     APR_HASH_KEY_STRING, entry);
+
+        MP_TRACE_h(MP_FUNC, "cached resolved handler %s", entry->name);
+    }
+
+    modperl_global_unlock(&MP_global_mgv_cache);
+}
+
+int modperl_mgv_cache_get(pTHX_ modperl_handler_t *handler, server_rec *s)
+{
+    MP_dSCFG(s);
+    modperl_interp_pool_t *mip = scfg->mip;
+    modperl_handler_t *entry = (modperl_handler_t *)NULL;
+
+    if (!(mip && handler->name)) {
+        return FALSE;
+    }
+
+    modperl_global_lock(&MP_global_mgv_cache);
+    if (mip->mgv_cache) {
+        entry = (modperl_handler_t *)apr_hash_get(mip->mgv_cache,
+                                                  handler->name,
+                                                  APR_HASH_KEY_STRING);
+    }
+    modperl_global_unlock(&MP_global_mgv_cache);
+
+    if (!entry) {
+        return FALSE;
+    }
+
+    /* the entry may come from a module required at request time by
+     * another clone, in which case this interpreter doesn't see it */
+    if (!modperl_mgv_lookup(aTHX_ entry->mgv_cv)) {
+        MP_TRACE_h(MP_FUNC, "cached handler %s is not available "
+                   "in this interpreter", handler->name);
+        return FALSE;
+    }
+
+    handler->mgv_cv  = entry->mgv_cv;
+    handler->mgv_obj = entry->mgv_obj;
+    handler->attrs   = entry->attrs;
+    handler->flags  |= entry->flags;
+
+    MP_TRACE_h(MP_FUNC, "using cached resolved handler %s", handler->name);
+
+    return TRUE;
+}
+
+#endif /* USE_ITHREADS */
+
 /* currently used for complex filters attributes parsing */
 /* XXX: may want to generalize it for any handlers */
 #define MODPERL_MGV_DEEP_RESOLVE(handler, p)                   \
@@ -468,6 +599,14 @@ static void modperl_hash_handlers(pTHX_ apr_pool_t *p, server_rec *s,
 
             modperl_mgv_resolve(aTHX_ handler, p, handler->name, TRUE);
         }
+
+#ifdef USE_ITHREADS
+        /* seed the cache before the clones are made, so handlers
+         * pushed at request time by name resolve without any lookups */
+        if (MpHandlerPARSED(handler)) {
+            modperl_mgv_cache_set(handler, s);
+        }
+#endif
     }
 }
 
@@ -49,6 +49,14 @@ int modperl_mgv_require_module(pTHX_ modperl_mgv_t *symbol,
 
 void modperl_mgv_hash_handlers(apr_pool_t *p, server_rec *s);
 
+#ifdef USE_ITHREADS
+void modperl_mgv_cache_init(apr_pool_t *p);
+
+void modperl_mgv_cache_set(modperl_handler_t *handler, server_rec *s);
+
+int modperl_mgv_cache_get(pTHX_ modperl_handler_t *handler, server_rec *s);
+#endif
+
 #define modperl_mgv_sv(sv) \
 (isGV(sv) ? GvSV(sv) : (SV*)sv)
 
@@ -27,8 +27,140 @@ typedef struct {
 typedef struct {
     server_rec *server;
     modperl_module_info_t *minfo;
+    /* created at startup (or memoized), so the pointer stays valid
+     * for the whole server generation */
+    int stable;
 } modperl_module_cfg_t;
 
+/*
+ * request time merges of config objects, which were both created at
+ * startup, are memoized for the server generation: with nested
+ * <Location>s the same DIR_MERGE chains run on every request.  the
+ * merged object is then shared by all the requests using it in that
+ * interpreter, so changes a handler makes to it are seen by the later
+ * ones
+ */
+typedef struct {
+    void *base;
+    void *add;
+    int type;
+} modperl_module_merge_key_t;
+
+typedef struct {
+    apr_pool_t *pool;
+    apr_hash_t *merged;
+    apr_uint32_t hits;
+    apr_uint32_t misses;
+} modperl_module_merge_cache_t;
+
+static modperl_global_t MP_global_module_merge;
+
+void modperl_module_merge_cache_init(apr_pool_t *p)
+{
+    modperl_module_merge_cache_t *cache =
+        (modperl_module_merge_cache_t *)apr_pcalloc(p, sizeof(*cache));
+    apr_allocator_t *allocator;
+
+    /* the cache is filled at request time from any thread, so it gets
+     * its own allocator, which is only used under the lock */
+    apr_allocator_create(&allocator);
+    apr_pool_create_ex(&cache->pool, p, NULL, allocator);
+    apr_allocator_owner_set(allocator, cache->pool);
+#if APR_HAS_THREADS
+    {
+        apr_thread_mutex_t *mutex;
+        apr_thread_mutex_create(&mutex, APR_THREAD_MUTEX_DEFAULT,
+                                cache->pool);
+        apr_allocator_mutex_set(allocator, mutex);
+    }
+#endif
+
+    cache->merged = apr_hash_make(cache->pool);
+
+    modperl_global_init(&MP_global_module_merge, p, (void *)cache,
+                        "module_merge");
+}
+
+static modperl_module_cfg_t *
+modperl_module_merge_cache_get(void *base, void *add, int type)
+{
+    modperl_module_merge_key_t key;
+    modperl_module_merge_cache_t *cache;
+    modperl_module_cfg_t *mrg;
+
+    memset(&key, 0, sizeof(key));
+    key.base = base;
+    key.add  = add;
+    key.type = type;
+
+    modperl_global_lock(&MP_global_module_merge);
+    cache = (modperl_module_merge_cache_t *)
+        modperl_global_get(&MP_global_module_merge);
+    mrg = (modperl_module_cfg_t *)apr_hash_get(cache->merged,
+                                               &key, sizeof(key));
+    modperl_global_unlock(&MP_global_module_merge);
+
+    return mrg;
+}
+
+/* returns the memoized cfg for (base, add, type), creating it as a
+ * copy of tmp if another thread hasn't done so already */
+static modperl_module_cfg_t *
+modperl_module_merge_cache_add(void *base, void *add, int type,
+                               modperl_module_cfg_t *tmp)
+{
+    modperl_module_merge_key_t key, *keyp;
+    modperl_module_merge_cache_t *cache;
+    modperl_module_cfg_t *mrg;
+
+    memset(&key, 0, sizeof(key));
+    key.base = base;
+    key.add  = add;
+    key.type = type;
+
+    modperl_global_lock(&MP_global_module_merge);
+    cache = (modperl_module_merge_cache_t *)
+        modperl_global_get(&MP_global_module_merge);
+    mrg = (modperl_module_cfg_t *)apr_hash_get(cache->merged,
+                                               &key, sizeof(key));
+    if (!mrg) {
+        mrg = (modperl_module_cfg_t *)
+            apr_pmemdup(cache->pool, tmp, sizeof(*mrg));
+        mrg->stable = TRUE;
+        keyp = (modperl_module_merge_key_t *)
+            apr_pmemdup(cache->pool, &key, sizeof(key));
+        apr_hash_set(cache->merged, keyp, sizeof(*keyp), mrg);
+    }
+    modperl_global_unlock(&MP_global_module_merge);
+
+    return mrg;
+}
+
+#define modperl_module_merge_cache_count(field)                 \
+    modperl_global_lock(&MP_global_module_merge);               \
+    ((modperl_module_merge_cache_t *)                           \
+     modperl_global_get(&MP_global_module_merge))->field++;     \
+    modperl_global_unlock(&MP_global_module_merge)
+
+SV *modperl_module_merge_stats(pTHX)
+{
+    HV *hv = newHV();
+    modperl_module_merge_cache_t *cache;
+
+    modperl_global_lock(&MP_global_module_merge);
+    cache = (modperl_module_merge_cache_t *)
+        modperl_global_get(&MP_global_module_merge);
+    if (cache) {
+        (void)hv_store(hv, "hits", 4, newSVuv(cache->hits), 0);
+        (void)hv_store(hv, "misses", 6, newSVuv(cache->misses), 0);
+        (void)hv_store(hv, "entries", 7,
+                       newSVuv(apr_hash_count(cache->merged)), 0);
+    }
+    modperl_global_unlock(&MP_global_module_merge);
+
+    return newRV_noinc((SV *)hv);
+}
+
 #define MP_MODULE_INFO(modp) \
     (modperl_module_info_t *)modp->dynamic_load_handle
 
@@ -61,15 +193,35 @@ static void *modperl_module_config_srv_create(apr_pool_t *p, server_rec *s)
     return modperl_module_cfg_new(p);
 }
 
+#define MP_MODULE_CONFIG_TABLE_KEY "ModPerl::Module::ConfigTable"
+
 static SV **modperl_module_config_hash_get(pTHX_ int create)
 {
     SV **svp;
 
-    /* XXX: could make this lookup faster */
+#if MP_PERL_VERSION_AT_LEAST(5, 10, 0)
+    /* the key's hash is the same for all interpreters, so compute it
+     * only once */
+    static U32 hash = 0;
+
+    if (!hash) {
+        PERL_HASH(hash, MP_MODULE_CONFIG_TABLE_KEY,
+                  MP_SSTRLEN(MP_MODULE_CONFIG_TABLE_KEY));
+    }
+
+    svp = (SV **)hv_common_key_len(PL_modglobal,
+                                   MP_MODULE_CONFIG_TABLE_KEY,
+                                   MP_SSTRLEN(MP_MODULE_CONFIG_TABLE_KEY),
+                                   create
+                                   ? (HV_FETCH_JUST_SV|HV_FETCH_LVALUE)
+                                   : HV_FETCH_JUST_SV,
+                                   NULL, hash);
+#else
     svp = hv_fetch(PL_modglobal,
-                   "ModPerl::Module::ConfigTable",
-                   MP_SSTRLEN("ModPerl::Module::ConfigTable"),
+                   MP_MODULE_CONFIG_TABLE_KEY,
+                   MP_SSTRLEN(MP_MODULE_CONFIG_TABLE_KEY),
                    create);
+#endif
 
     return svp;
 }
@@ -80,6 +232,48 @@ void modperl_module_config_table_set(pTHX_ PTR_TBL_t *table)
     sv_setiv(*svp, PTR2IV(table));
 }
 
+/* the table is created once per interpreter (or cloned with it), so
+ * cache its pointer in the interpreter's struct */
+#ifdef USE_ITHREADS
+static PTR_TBL_t *modperl_module_config_table_interp_get(pTHX_
+                                                         modperl_interp_t *interp)
+{
+    if (!interp) {
+        return modperl_module_config_table_get(aTHX_ TRUE);
+    }
+
+    if (!interp->config_table) {
+        interp->config_table = modperl_module_config_table_get(aTHX_ TRUE);
+    }
+
+    return interp->config_table;
+}
+#define MP_MODULE_CONFIG_TABLE_GET() \
+    modperl_module_config_table_interp_get(aTHX_ interp)
+#else
+#define MP_MODULE_CONFIG_TABLE_GET() \
+    modperl_module_config_table_get(aTHX_ TRUE)
+#endif
+
+/* lookups don't create the table: use the pointer cached in the
+ * interpreter's struct, unless there is no interpreter (yet) or the
+ * table hasn't been cached on it */
+#ifdef USE_ITHREADS
+static PTR_TBL_t *modperl_module_config_table_cached(pTHX)
+{
+    modperl_interp_t *interp = modperl_thx_interp_get(aTHX);
+
+    if (interp && interp->config_table) {
+        return interp->config_table;
+    }
+
+    return modperl_module_config_table_get(aTHX_ FALSE);
+}
+#else
+#define modperl_module_config_table_cached(thx) \
+    modperl_module_config_table_get(aTHX_ FALSE)
+#endif
+
 PTR_TBL_t *modperl_module_config_table_get(pTHX_ int create)
 {
     PTR_TBL_t *table = NULL;
@@ -170,7 +364,7 @@ static void *modperl_module_config_merge(apr_pool_t *p,
         *base = (modperl_module_cfg_t *)basev,
         *add  = (modperl_module_cfg_t *)addv;
     server_rec *s;
-    int is_startup;
+    int is_startup, memoize;
     PTR_TBL_t *table;
     SV *mrg_obj = (SV *)NULL, *base_obj, *add_obj;
     MP_dINTERP;
@@ -188,7 +382,7 @@ static void *modperl_module_config_merge(apr_pool_t *p,
 
     MP_INTERP_POOLa(p, s);
 
-    table = modperl_module_config_table_get(aTHX_ TRUE);
+    table = MP_MODULE_CONFIG_TABLE_GET();
     base_obj = modperl_svptr_table_fetch(aTHX_ table, base);
     add_obj  = modperl_svptr_table_fetch(aTHX_ table, add);
 
@@ -197,8 +391,31 @@ static void *modperl_module_config_merge(apr_pool_t *p,
         return addv;
     }
 
-    mrg = modperl_module_cfg_new(p);
-    memcpy(mrg, tmp, sizeof(*mrg));
+    memoize = !is_startup && base->stable && add && add->stable;
+
+    if (memoize &&
+        (mrg = modperl_module_merge_cache_get(base, add, type))) {
+        /* each interpreter has its own merged object */
+        if (modperl_svptr_table_fetch(aTHX_ table, mrg)) {
+            modperl_module_merge_cache_count(hits);
+            MP_INTERP_PUTBACK(interp, aTHX);
+            return (void *)mrg;
+        }
+    }
+
+    if (memoize) {
+        modperl_module_merge_cache_count(misses);
+    }
+
+    if (memoize && !mrg) {
+        /* memoized results live as long as the objects they merge */
+        mrg = modperl_module_merge_cache_add(base, add, type, tmp);
+    }
+    else if (!mrg) {
+        mrg = modperl_module_cfg_new(p);
+        memcpy(mrg, tmp, sizeof(*mrg));
+        mrg->stable = is_startup;
+    }
 
     method = (type == MP_CFG_MERGE_DIR) ?
         mrg->minfo->dir_merge :
@@ -238,7 +455,7 @@ static void *modperl_module_config_merge(apr_pool_t *p,
 
     modperl_svptr_table_store(aTHX_ table, mrg, mrg_obj);
 
-    if (!is_startup) {
+    if (!is_startup && !memoize) {
         modperl_module_config_obj_cleanup_register(aTHX_ p, table, mrg);
     }
 
@@ -296,6 +513,7 @@ modperl_module_config_create_obj(pTHX_
     /* used by merge functions to get a Perl interp */
     cfg->server = parms->server;
     cfg->minfo = minfo;
+    cfg->stable = is_startup;
 
     if (method && (gv = modperl_mgv_lookup(aTHX_ method))) {
         int count;
@@ -361,7 +579,7 @@ static const char *modperl_module_cmd_take123(cmd_parms *parms,
     SV *obj = (SV *)NULL;
     MP_dINTERP_POOLa(p, s);
 
-    table = modperl_module_config_table_get(aTHX_ TRUE);
+    table = MP_MODULE_CONFIG_TABLE_GET();
 
     if (s->is_virtual) {
         MP_dSCFG(s);
@@ -861,6 +1079,72 @@ const char *modperl_module_add(apr_pool_t *p, server_rec *s,
     return NULL;
 }
 
+/*
+ * Apache2::Module::get_config is often called several times per
+ * request for the same module and config vector, so when the current
+ * request is known (SetHandler perl-script or +GlobalRequest), the
+ * objects fetched for its own per-dir and server config vectors are
+ * remembered until the end of the request.  other vectors may be
+ * freed (and their address reused) before that, so they aren't.
+ */
+#define MP_MODULE_CONFIG_MEMO_SIZE 8
+
+typedef struct {
+#ifdef USE_ITHREADS
+    PerlInterpreter *perl; /* PerlInterpScope handler */
+#endif
+    ap_conf_vector_t *v;
+    const char *name;
+    SV *obj;
+} modperl_module_config_memo_entry_t;
+
+struct modperl_module_config_memo_t {
+    int nelts;
+    modperl_module_config_memo_entry_t entries[MP_MODULE_CONFIG_MEMO_SIZE];
+};
+
+static modperl_module_config_memo_t *
+modperl_module_config_memo_get(server_rec *s, ap_conf_vector_t *v)
+{
+    request_rec *r = NULL;
+    modperl_config_req_t *rcfg;
+
+    if (modperl_tls_get_request_rec(&r) != APR_SUCCESS || !r ||
+        r->server != s ||
+        !(v == r->per_dir_config || v == s->module_config) ||
+        !(rcfg = modperl_config_req_get(r))) {
+        return NULL;
+    }
+
+    if (!rcfg->module_config_memo) {
+        rcfg->module_config_memo = (modperl_module_config_memo_t *)
+            apr_pcalloc(r->pool, sizeof(*rcfg->module_config_memo));
+    }
+
+    return rcfg->module_config_memo;
+}
+
+static SV *modperl_module_config_memo_fetch(pTHX_
+                                            modperl_module_config_memo_t *memo,
+                                            ap_conf_vector_t *v,
+                                            const char *name)
+{
+    int i;
+
+    for (i = 0; i < memo->nelts; i++) {
+        modperl_module_config_memo_entry_t *entry = &memo->entries[i];
+        if (entry->v == v &&
+#ifdef USE_ITHREADS
+            entry->perl == aTHX &&
+#endif
+            strEQ(entry->name, name)) {
+            return entry->obj;
+        }
+    }
+
+    return NULL;
+}
+
 SV *modperl_module_config_get_obj(pTHX_ SV *pmodule, server_rec *s,
                                   ap_conf_vector_t *v)
 {
@@ -870,6 +1154,7 @@ SV *modperl_module_config_get_obj(pTHX_ SV *pmodule, server_rec *s,
     void *ptr;
     PTR_TBL_t *table;
     SV *obj;
+    modperl_module_config_memo_t *memo;
 
     if (!v) {
         v = s->module_config;
@@ -883,6 +1168,11 @@ SV *modperl_module_config_get_obj(pTHX_ SV *pmodule, server_rec *s,
         name = SvPV(pmodule, n_a);
     }
 
+    if ((memo = modperl_module_config_memo_get(s, v)) &&
+        (obj = modperl_module_config_memo_fetch(aTHX_ memo, v, name))) {
+        return obj;
+    }
+
     if (!(scfg->modules &&
           (modp = apr_hash_get(scfg->modules, name, APR_HASH_KEY_STRING)))) {
         return &PL_sv_undef;
@@ -892,7 +1182,7 @@ SV *modperl_module_config_get_obj(pTHX_ SV *pmodule, server_rec *s,
         return &PL_sv_undef;
     }
 
-    if (!(table = modperl_module_config_table_get(aTHX_ FALSE))) {
+    if (!(table = modperl_module_config_table_cached(aTHX))) {
         return &PL_sv_undef;
     }
 
@@ -900,6 +1190,18 @@ SV *modperl_module_config_get_obj(pTHX_ SV *pmodule, server_rec *s,
         return &PL_sv_undef;
     }
 
+    if (memo && memo->nelts < MP_MODULE_CONFIG_MEMO_SIZE) {
+        modperl_module_config_memo_entry_t *entry =
+            &memo->entries[memo->nelts++];
+#ifdef USE_ITHREADS
+        entry->perl = aTHX;
+#endif
+        entry->v = v;
+        /* modp->name lives as long as the module */
+        entry->name = modp->name;
+        entry->obj = obj;
+    }
+
     return obj;
 }
 
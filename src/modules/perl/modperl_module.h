@@ -27,6 +27,10 @@ const char *modperl_module_add(apr_pool_t *p, server_rec *s,
 SV *modperl_module_config_get_obj(pTHX_ SV *pmodule, server_rec *s,
                                   ap_conf_vector_t *v);
 
+void modperl_module_merge_cache_init(apr_pool_t *p);
+
+SV *modperl_module_merge_stats(pTHX);
+
 #endif /* MODPERL_MODULE_H */
 
 /*
@@ -20,12 +20,199 @@ static enum opcode MP_pp_map[] = {
 #ifdef MP_REFGEN_FIXUP
     OP_SREFGEN,
 #endif
-    OP_REQUIRE
+    OP_REQUIRE,
+    OP_DOFILE,
+    OP_OPEN,
+    OP_SYSOPEN,
+    OP_OPEN_DIR,
+    OP_STAT,
+    OP_LSTAT,
+    OP_FTRREAD,
+    OP_FTRWRITE,
+    OP_FTREXEC,
+    OP_FTEREAD,
+    OP_FTEWRITE,
+    OP_FTEEXEC,
+    OP_FTIS,
+    OP_FTSIZE,
+    OP_FTMTIME,
+    OP_FTATIME,
+    OP_FTCTIME,
+    OP_FTROWNED,
+    OP_FTEOWNED,
+    OP_FTZERO,
+    OP_FTSOCK,
+    OP_FTCHR,
+    OP_FTBLK,
+    OP_FTFILE,
+    OP_FTDIR,
+    OP_FTPIPE,
+    OP_FTSUID,
+    OP_FTSGID,
+    OP_FTSVTX,
+    OP_FTLINK,
+    OP_FTTEXT,
+    OP_FTBINARY
 };
 
 typedef OP * (*modperl_pp_t)(pTHX);
 
-static modperl_pp_t MP_PERL_ppaddr[MP_OP_max];
+/* the original PL_ppaddr entries, indexed by the perl opcode, so
+ * wrappers shared by several ops can find the one to call */
+static modperl_pp_t MP_PERL_ppaddr[MAXO];
+
+#define MP_PERL_PP_ORIG() MP_PERL_ppaddr[PL_op->op_type](aTHX)
+
+#ifdef WIN32
+#define MP_PATH_IS_ABS(p, len)                                  \
+    ((p)[0] == '/' || (p)[0] == '\\' || ((len) > 1 && (p)[1] == ':'))
+#else
+#define MP_PATH_IS_ABS(p, len) ((p)[0] == '/')
+#endif
+
+#define MP_PATH_IS_DOT_REL(p, len)                                      \
+    ((len) > 1 && (p)[0] == '.' &&                                      \
+     ((p)[1] == '/' || ((len) > 2 && (p)[1] == '.' && (p)[2] == '/')))
+
+/* returns a new mortal "$prefix$VirtualCwd/$path" if the virtual cwd
+ * is set and path is relative (and starts with ./ or ../ if dot_only
+ * is true), NULL otherwise */
+static SV *modperl_pp_vcwd_path(pTHX_ SV *orig,
+                                const char *prefix, STRLEN prefix_len,
+                                const char *path, STRLEN len, int dot_only)
+{
+    SV *vcwd, *sv;
+    STRLEN dir_len;
+    const char *dir;
+
+    if (!len || MP_PATH_IS_ABS(path, len)) {
+        return (SV *)NULL;
+    }
+
+    if (dot_only && !MP_PATH_IS_DOT_REL(path, len)) {
+        return (SV *)NULL;
+    }
+
+    vcwd = get_sv(MP_VIRTUAL_CWD, FALSE);
+    if (!(vcwd && SvOK(vcwd))) {
+        return (SV *)NULL;
+    }
+
+    dir = SvPV(vcwd, dir_len);
+    if (!dir_len) {
+        return (SV *)NULL;
+    }
+
+    sv = sv_2mortal(newSVpvn(prefix, prefix_len));
+    sv_catpvn(sv, dir, dir_len);
+    if (dir[dir_len-1] != '/') {
+        sv_catpvn(sv, "/", 1);
+    }
+    sv_catpvn(sv, path, len);
+
+    if (SvUTF8(orig)) {
+        SvUTF8_on(sv);
+    }
+    if (SvTAINTED(orig)) {
+        SvTAINTED_on(sv);
+    }
+
+    return sv;
+}
+
+/* only plain strings are file names, skip handles, references,
+ * numbers (require VERSION), etc. */
+#define MP_PP_IS_FILENAME(sv)                                   \
+    ((sv) && SvPOK(sv) && !SvROK(sv) && !isGV(sv) && !SvNIOKp(sv))
+
+static SV *modperl_pp_vcwd_sv(pTHX_ SV *sv, int dot_only)
+{
+    STRLEN len;
+    const char *path;
+
+    if (!MP_PP_IS_FILENAME(sv)) {
+        return (SV *)NULL;
+    }
+
+    path = SvPV_const(sv, len);
+
+    return modperl_pp_vcwd_path(aTHX_ sv, "", 0, path, len, dot_only);
+}
+
+/* 2-arg open: the file name is prefixed by the mode, e.g. ">>foo" */
+static SV *modperl_pp_vcwd_open2(pTHX_ SV *sv)
+{
+    STRLEN len;
+    const char *s, *e, *mode;
+
+    if (!MP_PP_IS_FILENAME(sv)) {
+        return (SV *)NULL;
+    }
+
+    s = SvPV_const(sv, len);
+    e = s + len;
+
+    while (s < e && isSPACE(*s)) {
+        s++;
+    }
+    mode = s;
+
+    if (s < e && *s == '+') {
+        s++;
+    }
+    if (s < e && *s == '<') {
+        s++;
+    }
+    else if (s < e && *s == '>') {
+        s++;
+        if (s < e && *s == '>') {
+            s++;
+        }
+    }
+
+    /* dups and pipes */
+    if (s < e && (*s == '&' || *s == '|')) {
+        return (SV *)NULL;
+    }
+    while (e > s && isSPACE(e[-1])) {
+        e--;
+    }
+    if (e > s && e[-1] == '|') {
+        return (SV *)NULL;
+    }
+
+    while (s < e && isSPACE(*s)) {
+        s++;
+    }
+
+    /* STDIN/STDOUT */
+    if (e - s == 1 && *s == '-') {
+        return (SV *)NULL;
+    }
+
+    return modperl_pp_vcwd_path(aTHX_ sv, mode, s - mode, s, e - s, FALSE);
+}
+
+/* 3-arg open: only rewrite the file name for plain file modes, not
+ * for pipes and dups */
+static int modperl_pp_open_mode_is_file(pTHX_ SV *sv)
+{
+    STRLEN len, i;
+    const char *mode;
+
+    if (!(sv && SvOK(sv) && !SvROK(sv))) {
+        return FALSE;
+    }
+
+    mode = SvPV_const(sv, len);
+    for (i = 0; i < len && mode[i] != ':'; i++) {
+        if (mode[i] == '|' || mode[i] == '&' || mode[i] == '-') {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
 
 #ifdef MP_REFGEN_FIXUP
 
@@ -52,7 +239,7 @@ static OP *modperl_pp_srefgen(pTHX)
     }
 
     /* o = Perl_pp_srefgen(aTHX) */
-    o = MP_PERL_ppaddr[MP_OP_SREFGEN](aTHX);
+    o = MP_PERL_PP_ORIG();
 
     if (sv) {
         /* restore original flags */
@@ -64,45 +251,185 @@ static OP *modperl_pp_srefgen(pTHX)
 
 #endif /* MP_REFGEN_FIXUP */
 
+/* require and do FILE: only ./ and ../ names are resolved against
+ * the virtual cwd, the others are searched in @INC */
 static OP *modperl_pp_require(pTHX)
 {
-    /* nothing yet */
-    return MP_PERL_ppaddr[MP_OP_REQUIRE](aTHX);
+    dSP;
+    SV *sv = modperl_pp_vcwd_sv(aTHX_ TOPs, TRUE);
+
+    if (sv) {
+        SETs(sv);
+    }
+
+    return MP_PERL_PP_ORIG();
+}
+
+/* open(FH, EXPR), open(FH, MODE, EXPR, ...) */
+static OP *modperl_pp_open(pTHX)
+{
+    dSP;
+    SV **mark = PL_stack_base + TOPMARK;
+    SV *sv = (SV *)NULL;
+
+    /* mark[1] is the handle */
+    switch (SP - (mark + 1)) {
+      case 0:
+        break;
+      case 1:
+        if ((sv = modperl_pp_vcwd_open2(aTHX_ mark[2]))) {
+            mark[2] = sv;
+        }
+        break;
+      default:
+        if (modperl_pp_open_mode_is_file(aTHX_ mark[2]) &&
+            (sv = modperl_pp_vcwd_sv(aTHX_ mark[3], FALSE))) {
+            mark[3] = sv;
+        }
+        break;
+    }
+
+    return MP_PERL_PP_ORIG();
+}
+
+/* sysopen(FH, PATH, MODE[, PERMS]) doesn't use a mark, the path is
+ * the second of its MAXARG arguments */
+static OP *modperl_pp_sysopen(pTHX)
+{
+    dSP;
+    SV *sv;
+    int path = MAXARG - 2;
+
+    if (path >= 0 && (sv = modperl_pp_vcwd_sv(aTHX_ *(SP - path), FALSE))) {
+        *(SP - path) = sv;
+    }
+
+    return MP_PERL_PP_ORIG();
+}
+
+/* opendir(DH, EXPR) */
+static OP *modperl_pp_open_dir(pTHX)
+{
+    dSP;
+    SV *sv = modperl_pp_vcwd_sv(aTHX_ TOPs, FALSE);
+
+    if (sv) {
+        SETs(sv);
+    }
+
+    return MP_PERL_PP_ORIG();
+}
+
+/* stat, lstat and the file tests: the name is on the top of the
+ * stack, unless a handle (or _) is used or the test is stacked
+ * (-f -w $file) */
+static OP *modperl_pp_filetest(pTHX)
+{
+    if (!(PL_op->op_flags & OPf_REF)
+#ifdef OPpFT_STACKED
+        && !(PL_op->op_private & OPpFT_STACKED)
+#endif
+        ) {
+        dSP;
+        SV *sv = modperl_pp_vcwd_sv(aTHX_ TOPs, FALSE);
+        if (sv) {
+            SETs(sv);
+        }
+    }
+
+    return MP_PERL_PP_ORIG();
 }
 
 static modperl_pp_t MP_ppaddr[] = {
 #ifdef MP_REFGEN_FIXUP
     modperl_pp_srefgen,
 #endif
-    modperl_pp_require
+    modperl_pp_require,    /* require */
+    modperl_pp_require,    /* do FILE */
+    modperl_pp_open,
+    modperl_pp_sysopen,
+    modperl_pp_open_dir,
+    modperl_pp_filetest,   /* stat */
+    modperl_pp_filetest,   /* lstat */
+    modperl_pp_filetest,   /* -r */
+    modperl_pp_filetest,   /* -w */
+    modperl_pp_filetest,   /* -x */
+    modperl_pp_filetest,   /* -R */
+    modperl_pp_filetest,   /* -W */
+    modperl_pp_filetest,   /* -X */
+    modperl_pp_filetest,   /* -e */
+    modperl_pp_filetest,   /* -s */
+    modperl_pp_filetest,   /* -M */
+    modperl_pp_filetest,   /* -A */
+    modperl_pp_filetest,   /* -C */
+    modperl_pp_filetest,   /* -O */
+    modperl_pp_filetest,   /* -o */
+    modperl_pp_filetest,   /* -z */
+    modperl_pp_filetest,   /* -S */
+    modperl_pp_filetest,   /* -c */
+    modperl_pp_filetest,   /* -b */
+    modperl_pp_filetest,   /* -f */
+    modperl_pp_filetest,   /* -d */
+    modperl_pp_filetest,   /* -p */
+    modperl_pp_filetest,   /* -u */
+    modperl_pp_filetest,   /* -g */
+    modperl_pp_filetest,   /* -k */
+    modperl_pp_filetest,   /* -l */
+    modperl_pp_filetest,   /* -T */
+    modperl_pp_filetest    /* -B */
 };
 
 void modperl_perl_pp_set(modperl_perl_opcode_e idx)
 {
     int pl_idx = MP_pp_map[idx];
 
+    if (MP_PERL_ppaddr[pl_idx]) {
+        /* already replaced */
+        return;
+    }
+
     /* save original */
-    MP_PERL_ppaddr[idx] = PL_ppaddr[pl_idx];
+    MP_PERL_ppaddr[pl_idx] = PL_ppaddr[pl_idx];
 
     /* replace with our own */
     PL_ppaddr[pl_idx] = MP_ppaddr[idx];
 }
 
+/* the virtual cwd ops cost a lookup of $ModPerl::Util::VirtualCwd on
+ * every file op, so they are only installed on demand */
 void modperl_perl_pp_set_all(void)
 {
     int i;
 
-    for (i=0; i<MP_OP_max; i++) {
+    for (i=0; i<MP_OP_VCWD_FIRST; i++) {
+        modperl_perl_pp_set(i);
+    }
+}
+
+/* PL_ppaddr is shared by all the interpreters, and this may be called
+ * at request time */
+void modperl_perl_pp_vcwd_set(pTHX)
+{
+    int i;
+
+    OP_REFCNT_LOCK;
+    for (i=MP_OP_VCWD_FIRST; i<MP_OP_max; i++) {
         modperl_perl_pp_set(i);
     }
+    OP_REFCNT_UNLOCK;
 }
 
 void modperl_perl_pp_unset(modperl_perl_opcode_e idx)
 {
     int pl_idx = MP_pp_map[idx];
 
+    if (!MP_PERL_ppaddr[pl_idx]) {
+        return;
+    }
+
     /* restore original */
-    PL_ppaddr[pl_idx] = MP_PERL_ppaddr[idx];
+    PL_ppaddr[pl_idx] = MP_PERL_ppaddr[pl_idx];
+    MP_PERL_ppaddr[pl_idx] = NULL;
 }
 
 void modperl_perl_pp_unset_all(void)
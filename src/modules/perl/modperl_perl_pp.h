@@ -28,14 +28,60 @@ typedef enum {
 #ifdef MP_REFGEN_FIXUP
     MP_OP_SREFGEN,
 #endif
+    /* the ops resolving file names against the virtual cwd, only
+     * replaced once modperl_perl_pp_vcwd_set() was called */
     MP_OP_REQUIRE,
+    MP_OP_VCWD_FIRST = MP_OP_REQUIRE,
+    MP_OP_DOFILE,
+    MP_OP_OPEN,
+    MP_OP_SYSOPEN,
+    MP_OP_OPEN_DIR,
+    MP_OP_STAT,
+    MP_OP_LSTAT,
+    MP_OP_FTRREAD,
+    MP_OP_FTRWRITE,
+    MP_OP_FTREXEC,
+    MP_OP_FTEREAD,
+    MP_OP_FTEWRITE,
+    MP_OP_FTEEXEC,
+    MP_OP_FTIS,
+    MP_OP_FTSIZE,
+    MP_OP_FTMTIME,
+    MP_OP_FTATIME,
+    MP_OP_FTCTIME,
+    MP_OP_FTROWNED,
+    MP_OP_FTEOWNED,
+    MP_OP_FTZERO,
+    MP_OP_FTSOCK,
+    MP_OP_FTCHR,
+    MP_OP_FTBLK,
+    MP_OP_FTFILE,
+    MP_OP_FTDIR,
+    MP_OP_FTPIPE,
+    MP_OP_FTSUID,
+    MP_OP_FTSGID,
+    MP_OP_FTSVTX,
+    MP_OP_FTLINK,
+    MP_OP_FTTEXT,
+    MP_OP_FTBINARY,
     MP_OP_max
 } modperl_perl_opcode_e;
 
+/* when set (local-ized by ModPerl::RegistryCooker), relative file
+ * names passed to open, sysopen, opendir, stat, lstat and the file
+ * test operators, and ./ and ../ file names passed to require and do,
+ * are resolved against this directory instead of the process' cwd.
+ * it's a per-interpreter chdir(), safe to use under threaded mpms.
+ * only code compiled after modperl_perl_pp_vcwd_set() (see
+ * ModPerl::Util::enable_virtual_cwd) is affected */
+#define MP_VIRTUAL_CWD "ModPerl::Util::VirtualCwd"
+
 void modperl_perl_pp_set(modperl_perl_opcode_e idx);
 
 void modperl_perl_pp_set_all(void);
 
+void modperl_perl_pp_vcwd_set(pTHX);
+
 void modperl_perl_pp_unset(modperl_perl_opcode_e idx);
 
 void modperl_perl_pp_unset_all(void);
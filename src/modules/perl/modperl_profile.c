@@ -0,0 +1,235 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+
+#if defined(I_SYS_RESOURCE) && !defined(WIN32)
+#include <sys/resource.h>
+#endif
+
+/* the data is kept per process and shared by all interpreters, each
+ * modperl_callback() invocation adds a sample under the global lock */
+
+typedef struct {
+    int status;
+    apr_uint64_t count;
+} modperl_profile_status_t;
+
+typedef struct {
+    const char *name;
+    apr_uint64_t calls;
+    apr_uint64_t errors;
+    apr_interval_time_t wall_total;
+    apr_interval_time_t wall_min;
+    apr_interval_time_t wall_max;
+    apr_interval_time_t cpu_total;
+    apr_interval_time_t cpu_min;
+    apr_interval_time_t cpu_max;
+    apr_hash_t *status;
+} modperl_profile_entry_t;
+
+typedef struct {
+    apr_pool_t *pool;
+    apr_hash_t *entries;
+} modperl_profile_t;
+
+static modperl_global_t MP_global_profile;
+
+void modperl_profile_init(apr_pool_t *p)
+{
+    modperl_profile_t *prof =
+        (modperl_profile_t *)apr_pcalloc(p, sizeof(*prof));
+
+    (void)apr_pool_create(&prof->pool, p);
+    prof->entries = apr_hash_make(prof->pool);
+
+    modperl_global_init(&MP_global_profile, p, (void *)prof, "profile");
+}
+
+/* the cpu time used by the calling thread so far.  times() is the
+ * fallback where there is no per-thread clock: it is per process, so
+ * under the threaded mpms a handler is also charged for what the
+ * other threads did meanwhile, and it only counts in 1/HZ ticks, so
+ * most handlers will read 0 */
+apr_interval_time_t modperl_profile_cpu_now(void)
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return (apr_interval_time_t)ts.tv_sec * APR_USEC_PER_SEC +
+            ts.tv_nsec / 1000;
+    }
+#elif defined(RUSAGE_THREAD)
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_THREAD, &ru) == 0) {
+        return (apr_interval_time_t)
+            (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * APR_USEC_PER_SEC +
+            ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+    }
+#endif
+    {
+        struct tms tms;
+
+        (void)PerlProc_times(&tms);
+
+        return (apr_interval_time_t)(tms.tms_utime + tms.tms_stime)
+            * APR_USEC_PER_SEC / MP_HZ;
+    }
+}
+
+void modperl_profile_record(const char *name,
+                            modperl_times_t *start, modperl_times_t *end,
+                            int status, int failed)
+{
+    modperl_profile_t *prof;
+    modperl_profile_entry_t *entry;
+    modperl_profile_status_t *st;
+    apr_interval_time_t wall = end->wall - start->wall;
+    apr_interval_time_t cpu  = MP_TIMES_CPU_USEC(*start, *end);
+
+    modperl_global_lock(&MP_global_profile);
+
+    prof = (modperl_profile_t *)modperl_global_get(&MP_global_profile);
+
+    entry = (modperl_profile_entry_t *)apr_hash_get(prof->entries, name,
+                                                    APR_HASH_KEY_STRING);
+    if (!entry) {
+        entry = (modperl_profile_entry_t *)apr_pcalloc(prof->pool,
+                                                       sizeof(*entry));
+        entry->name     = apr_pstrdup(prof->pool, name);
+        entry->status   = apr_hash_make(prof->pool);
+        entry->wall_min = wall;
+        entry->cpu_min  = cpu;
+        apr_hash_set(prof->entries, entry->name, APR_HASH_KEY_STRING, entry);
+    }
+
+    entry->calls++;
+    if (failed) {
+        entry->errors++;
+    }
+
+    entry->wall_total += wall;
+    if (wall < entry->wall_min) {
+        entry->wall_min = wall;
+    }
+    if (wall > entry->wall_max) {
+        entry->wall_max = wall;
+    }
+
+    entry->cpu_total += cpu;
+    if (cpu < entry->cpu_min) {
+        entry->cpu_min = cpu;
+    }
+    if (cpu > entry->cpu_max) {
+        entry->cpu_max = cpu;
+    }
+
+    st = (modperl_profile_status_t *)apr_hash_get(entry->status, &status,
+                                                  sizeof(status));
+    if (!st) {
+        st = (modperl_profile_status_t *)apr_pcalloc(prof->pool,
+                                                     sizeof(*st));
+        st->status = status;
+        apr_hash_set(entry->status, &st->status, sizeof(st->status), st);
+    }
+    st->count++;
+
+    modperl_global_unlock(&MP_global_profile);
+}
+
+void modperl_profile_reset(void)
+{
+    modperl_profile_t *prof;
+
+    modperl_global_lock(&MP_global_profile);
+
+    prof = (modperl_profile_t *)modperl_global_get(&MP_global_profile);
+    apr_pool_clear(prof->pool);
+    prof->entries = apr_hash_make(prof->pool);
+
+    modperl_global_unlock(&MP_global_profile);
+
+    MP_TRACE_g(MP_FUNC, "handlers profile reset");
+}
+
+#define MP_PROFILE_STORE(hv, entry, key)                          \
+    (void)hv_store(hv, #key, sizeof(#key) - 1,                    \
+                   newSVnv((NV)entry->key), 0)
+
+/* { name => { calls => ..., errors => ..., wall_total => ...,
+ *             ..., status => { status => count, ... } }, ... }
+ * times are in microseconds */
+SV *modperl_profile_as_hvrv(pTHX)
+{
+    HV *hv = newHV();
+    modperl_profile_t *prof;
+    apr_hash_index_t *hi;
+
+    modperl_global_lock(&MP_global_profile);
+
+    prof = (modperl_profile_t *)modperl_global_get(&MP_global_profile);
+
+    for (hi = apr_hash_first(NULL, prof->entries); hi;
+         hi = apr_hash_next(hi)) {
+        modperl_profile_entry_t *entry;
+        apr_hash_index_t *shi;
+        HV *entry_hv  = newHV();
+        HV *status_hv = newHV();
+        void *val;
+
+        apr_hash_this(hi, NULL, NULL, &val);
+        entry = (modperl_profile_entry_t *)val;
+
+        MP_PROFILE_STORE(entry_hv, entry, calls);
+        MP_PROFILE_STORE(entry_hv, entry, errors);
+        MP_PROFILE_STORE(entry_hv, entry, wall_total);
+        MP_PROFILE_STORE(entry_hv, entry, wall_min);
+        MP_PROFILE_STORE(entry_hv, entry, wall_max);
+        MP_PROFILE_STORE(entry_hv, entry, cpu_total);
+        MP_PROFILE_STORE(entry_hv, entry, cpu_min);
+        MP_PROFILE_STORE(entry_hv, entry, cpu_max);
+
+        for (shi = apr_hash_first(NULL, entry->status); shi;
+             shi = apr_hash_next(shi)) {
+            modperl_profile_status_t *st;
+            char buf[32];
+            int len;
+
+            apr_hash_this(shi, NULL, NULL, &val);
+            st = (modperl_profile_status_t *)val;
+            len = apr_snprintf(buf, sizeof(buf), "%d", st->status);
+            (void)hv_store(status_hv, buf, len, newSVnv((NV)st->count), 0);
+        }
+
+        (void)hv_store(entry_hv, "status", 6,
+                       newRV_noinc((SV *)status_hv), 0);
+        (void)hv_store(hv, entry->name, strlen(entry->name),
+                       newRV_noinc((SV *)entry_hv), 0);
+    }
+
+    modperl_global_unlock(&MP_global_profile);
+
+    return newRV_noinc((SV *)hv);
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
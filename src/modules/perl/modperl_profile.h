@@ -0,0 +1,44 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODPERL_PROFILE_H
+#define MODPERL_PROFILE_H
+
+/*
+ * per-process handlers profile, collected by modperl_callback() for
+ * servers configured with PerlOptions +ProfileHandlers
+ */
+
+void modperl_profile_init(apr_pool_t *p);
+
+apr_interval_time_t modperl_profile_cpu_now(void);
+
+void modperl_profile_record(const char *name,
+                            modperl_times_t *start, modperl_times_t *end,
+                            int status, int failed);
+
+void modperl_profile_reset(void);
+
+SV *modperl_profile_as_hvrv(pTHX);
+
+#endif /* MODPERL_PROFILE_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,231 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+
+/* the startup is single-threaded, so the data needs no locking.  it's
+ * only collected between the PerlStartupProfile directive and the
+ * writing of the report at the end of the post_config phase */
+
+struct modperl_startup_profile_entry_t {
+    const char *type;
+    const char *name;
+    int depth;
+    int failed;
+    apr_time_t start;
+    apr_interval_time_t elapsed;
+    apr_int64_t rss_start;
+    apr_int64_t rss;          /* growth in bytes, -1 if unknown */
+    HV *inc;                  /* %INC before the load */
+    apr_array_header_t *pulled; /* %INC keys added by the load */
+};
+
+typedef struct {
+    const char *file;
+    apr_pool_t *pool;
+    apr_array_header_t *entries;
+    int depth;
+} modperl_startup_profile_t;
+
+static modperl_startup_profile_t MP_startup_profile;
+
+static apr_int64_t modperl_startup_profile_rss(void)
+{
+#ifdef MP_USE_GTOP
+    glibtop_proc_mem mem;
+    glibtop_get_proc_mem(&mem, getpid());
+    return (apr_int64_t)mem.resident;
+#else
+    return -1;
+#endif
+}
+
+void modperl_startup_profile_init(apr_pool_t *p)
+{
+    /* re-read on restart */
+    MP_startup_profile.file    = NULL;
+    MP_startup_profile.pool    = p;
+    MP_startup_profile.entries = NULL;
+    MP_startup_profile.depth   = 0;
+}
+
+const char *modperl_startup_profile_file_set(apr_pool_t *p, const char *arg)
+{
+    const char *file = ap_server_root_relative(p, arg);
+
+    if (!file) {
+        return apr_pstrcat(p, "PerlStartupProfile: invalid file path ",
+                           arg, NULL);
+    }
+
+    MP_startup_profile.file    = file;
+    MP_startup_profile.entries =
+        apr_array_make(MP_startup_profile.pool, 32,
+                       sizeof(modperl_startup_profile_entry_t *));
+
+    return NULL;
+}
+
+modperl_startup_profile_entry_t *
+modperl_startup_profile_start(pTHX_ const char *type, const char *name)
+{
+    modperl_startup_profile_entry_t *entry;
+    apr_pool_t *p = MP_startup_profile.pool;
+    HV *inc = GvHVn(PL_incgv);
+    HE *he;
+
+    if (!MP_startup_profile.entries) {
+        return NULL;
+    }
+
+    entry = (modperl_startup_profile_entry_t *)apr_pcalloc(p, sizeof(*entry));
+    entry->type  = type;
+    entry->name  = apr_pstrdup(p, name);
+    entry->depth = MP_startup_profile.depth++;
+    entry->inc   = newHV();
+
+    hv_iterinit(inc);
+    while ((he = hv_iternext(inc))) {
+        I32 len;
+        char *key = hv_iterkey(he, &len);
+        (void)hv_store(entry->inc, key, len,
+                       SvREFCNT_inc_simple_NN(&PL_sv_yes), 0);
+    }
+
+    *(modperl_startup_profile_entry_t **)
+        apr_array_push(MP_startup_profile.entries) = entry;
+
+    entry->rss_start = modperl_startup_profile_rss();
+    entry->start = apr_time_now();
+
+    return entry;
+}
+
+void modperl_startup_profile_stop(pTHX_
+                                  modperl_startup_profile_entry_t *entry,
+                                  int ok)
+{
+    HV *inc = GvHVn(PL_incgv);
+    HE *he;
+
+    if (!entry) {
+        return;
+    }
+
+    entry->elapsed = apr_time_now() - entry->start;
+    entry->rss = entry->rss_start < 0 ? -1 :
+        modperl_startup_profile_rss() - entry->rss_start;
+    entry->failed = !ok;
+    MP_startup_profile.depth--;
+
+    entry->pulled = apr_array_make(MP_startup_profile.pool, 4,
+                                   sizeof(char *));
+
+    hv_iterinit(inc);
+    while ((he = hv_iternext(inc))) {
+        I32 len;
+        char *key = hv_iterkey(he, &len);
+        if (!hv_exists(entry->inc, key, len)) {
+            *(char **)apr_array_push(entry->pulled) =
+                apr_pstrmemdup(MP_startup_profile.pool, key, len);
+        }
+    }
+
+    SvREFCNT_dec((SV *)entry->inc);
+    entry->inc = (HV *)NULL;
+}
+
+void modperl_startup_profile_write(server_rec *s, apr_pool_t *p)
+{
+    modperl_startup_profile_entry_t **entries;
+    apr_interval_time_t total = 0;
+    apr_file_t *fp;
+    apr_status_t rc;
+    int i, j, count;
+
+    if (!MP_startup_profile.entries) {
+        return;
+    }
+
+    entries = (modperl_startup_profile_entry_t **)
+        MP_startup_profile.entries->elts;
+    count = MP_startup_profile.entries->nelts;
+
+    /* nothing is collected after this point */
+    MP_startup_profile.entries = NULL;
+
+    rc = apr_file_open(&fp, MP_startup_profile.file,
+                       APR_WRITE|APR_CREATE|APR_TRUNCATE,
+                       APR_OS_DEFAULT, p);
+    if (rc != APR_SUCCESS) {
+        ap_log_error(APLOG_MARK, APLOG_WARNING, rc, s,
+                     "PerlStartupProfile: can't open %s",
+                     MP_startup_profile.file);
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (entries[i]->depth == 0) {
+            total += entries[i]->elapsed;
+        }
+    }
+
+    apr_file_printf(fp, "# mod_perl startup profile, pid %" APR_PID_T_FMT
+                    ", %d loads, %.3f secs\n",
+                    getpid(), count, (double)total / APR_USEC_PER_SEC);
+    apr_file_printf(fp, "# %10s %10s %-7s %s\n",
+                    "msecs", "rss(KB)", "type", "name");
+
+    for (i = 0; i < count; i++) {
+        modperl_startup_profile_entry_t *entry = entries[i];
+        char **pulled;
+
+        apr_file_printf(fp, "  %10.3f ",
+                        (double)entry->elapsed / 1000);
+        if (entry->rss < 0) {
+            apr_file_printf(fp, "%10s ", "-");
+        }
+        else {
+            apr_file_printf(fp, "%10" APR_INT64_T_FMT " ", entry->rss / 1024);
+        }
+        apr_file_printf(fp, "%-7s %*s%s%s\n", entry->type,
+                        entry->depth * 2, "", entry->name,
+                        entry->failed ? " (failed)" : "");
+
+        if (!entry->pulled) {
+            continue; /* never finished, e.g. died on exit() */
+        }
+
+        pulled = (char **)entry->pulled->elts;
+        for (j = 0; j < entry->pulled->nelts; j++) {
+            apr_file_printf(fp, "  %10s %10s %-7s %*s  + %s\n",
+                            "", "", "", entry->depth * 2, "", pulled[j]);
+        }
+    }
+
+    apr_file_close(fp);
+
+    ap_log_error(APLOG_MARK, APLOG_INFO, 0, s,
+                 "mod_perl: startup profile written to %s (%.3f secs)",
+                 MP_startup_profile.file, (double)total / APR_USEC_PER_SEC);
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,49 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODPERL_STARTUP_PROFILE_H
+#define MODPERL_STARTUP_PROFILE_H
+
+/*
+ * startup profile enabled by PerlStartupProfile: every module and file
+ * loaded before the interpreters are cloned is timed, and the report
+ * is written once the post_config phase is over
+ */
+
+typedef struct modperl_startup_profile_entry_t
+    modperl_startup_profile_entry_t;
+
+void modperl_startup_profile_init(apr_pool_t *p);
+
+const char *modperl_startup_profile_file_set(apr_pool_t *p, const char *arg);
+
+modperl_startup_profile_entry_t *
+modperl_startup_profile_start(pTHX_ const char *type, const char *name);
+
+void modperl_startup_profile_stop(pTHX_
+                                  modperl_startup_profile_entry_t *entry,
+                                  int ok);
+
+void modperl_startup_profile_write(server_rec *s, apr_pool_t *p);
+
+#endif /* MODPERL_STARTUP_PROFILE_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -49,6 +49,20 @@
         } \
     })
 
+/* unlike the above, always compiled in, see modperl_profile.c.
+ * cpu is the user + sys time of the calling thread in microseconds,
+ * see modperl_profile_cpu_now() */
+typedef struct {
+    apr_time_t wall;
+    apr_interval_time_t cpu;
+} modperl_times_t;
+
+#define MP_TIMES_NOW(t) \
+    ((t).wall = apr_time_now(), (t).cpu = modperl_profile_cpu_now())
+
+/* user + sys time spent between the two samples, in microseconds */
+#define MP_TIMES_CPU_USEC(start, end) ((end).cpu - (start).cpu)
+
 #endif /* MODPERL_TIME_H */
 
 /*
@@ -0,0 +1,231 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+
+typedef struct {
+    const char *what;
+    const char *name;
+    apr_time_t start;
+    apr_interval_time_t usec;
+} modperl_timeline_event_t;
+
+struct modperl_timeline_t {
+    apr_time_t start;
+    apr_array_header_t *events;
+};
+
+typedef struct {
+    apr_uint32_t requests;
+    int next;
+    char *records[MP_TIMELINE_RING_SIZE];
+} modperl_timeline_ring_t;
+
+static modperl_global_t MP_global_timeline;
+
+static apr_status_t modperl_timeline_ring_free(void *data)
+{
+    modperl_timeline_ring_t *ring = (modperl_timeline_ring_t *)data;
+    int i;
+
+    for (i = 0; i < MP_TIMELINE_RING_SIZE; i++) {
+        if (ring->records[i]) {
+            free(ring->records[i]);
+            ring->records[i] = NULL;
+        }
+    }
+
+    return APR_SUCCESS;
+}
+
+void modperl_timeline_init(apr_pool_t *p)
+{
+    modperl_timeline_ring_t *ring =
+        (modperl_timeline_ring_t *)apr_pcalloc(p, sizeof(*ring));
+
+    /* records outlive the requests which made them, so they are
+     * malloc()ed and released when the ring is replaced */
+    apr_pool_cleanup_register(p, (void *)ring,
+                              modperl_timeline_ring_free,
+                              apr_pool_cleanup_null);
+
+    modperl_global_init(&MP_global_timeline, p, (void *)ring, "timeline");
+}
+
+/* subrequests add their events to the main request's timeline */
+static modperl_timeline_t *modperl_timeline_get(request_rec *r)
+{
+    modperl_config_req_t *rcfg;
+
+    if (!r) {
+        return NULL;
+    }
+
+    while (r->main) {
+        r = r->main;
+    }
+
+    rcfg = modperl_config_req_get(r);
+
+    return rcfg ? rcfg->timeline : NULL;
+}
+
+apr_time_t modperl_timeline_now(request_rec *r)
+{
+    return modperl_timeline_get(r) ? apr_time_now() : 0;
+}
+
+void modperl_timeline_add(request_rec *r, const char *what,
+                          const char *name, apr_time_t start)
+{
+    modperl_timeline_t *timeline;
+    modperl_timeline_event_t *event;
+
+    if (!start || !(timeline = modperl_timeline_get(r))) {
+        return;
+    }
+
+    event = (modperl_timeline_event_t *)apr_array_push(timeline->events);
+    event->what  = what;
+    event->name  = name ? name : "";
+    event->start = start;
+    event->usec  = apr_time_now() - start;
+}
+
+static apr_status_t modperl_timeline_store(void *data)
+{
+    request_rec *r = (request_rec *)data;
+    modperl_timeline_t *timeline = modperl_timeline_get(r);
+    modperl_timeline_event_t *events;
+    modperl_timeline_ring_t *ring;
+    apr_array_header_t *json;
+    const char *record;
+    apr_size_t len;
+    int i;
+
+    if (!timeline) {
+        return APR_SUCCESS;
+    }
+
+    json = apr_array_make(r->pool, timeline->events->nelts * 2 + 2,
+                          sizeof(char *));
+
+    *(const char **)apr_array_push(json) =
+        apr_psprintf(r->pool,
+                     "{\"pid\":%" APR_PID_T_FMT ",\"start\":%" APR_TIME_T_FMT
+                     ",\"method\":%s,\"uri\":%s,\"status\":%d,"
+                     "\"usec\":%" APR_TIME_T_FMT ",\"events\":[",
+                     getpid(), timeline->start,
+                     modperl_json_str(r->pool, r->method ? r->method : ""),
+                     modperl_json_str(r->pool, r->uri ? r->uri : ""),
+                     r->status, apr_time_now() - timeline->start);
+
+    events = (modperl_timeline_event_t *)timeline->events->elts;
+    for (i = 0; i < timeline->events->nelts; i++) {
+        *(const char **)apr_array_push(json) =
+            apr_psprintf(r->pool,
+                         "%s{\"what\":\"%s\",\"name\":%s,"
+                         "\"offset\":%" APR_TIME_T_FMT ","
+                         "\"usec\":%" APR_TIME_T_FMT "}",
+                         i ? "," : "", events[i].what,
+                         modperl_json_str(r->pool, events[i].name),
+                         events[i].start - timeline->start,
+                         events[i].usec);
+    }
+
+    *(const char **)apr_array_push(json) = "]}";
+
+    record = apr_array_pstrcat(r->pool, json, '\0');
+    len = strlen(record);
+
+    modperl_global_lock(&MP_global_timeline);
+
+    ring = (modperl_timeline_ring_t *)modperl_global_get(&MP_global_timeline);
+    if (ring->records[ring->next]) {
+        free(ring->records[ring->next]);
+    }
+    if ((ring->records[ring->next] = malloc(len + 1))) {
+        memcpy(ring->records[ring->next], record, len + 1);
+    }
+    ring->next = (ring->next + 1) % MP_TIMELINE_RING_SIZE;
+
+    modperl_global_unlock(&MP_global_timeline);
+
+    return APR_SUCCESS;
+}
+
+void modperl_timeline_sample(request_rec *r, modperl_config_req_t *rcfg)
+{
+    MP_dSCFG(r->server);
+    modperl_timeline_ring_t *ring;
+    int sampled;
+
+    if (scfg->timeline_sample <= 0 || r->main) {
+        return;
+    }
+
+    modperl_global_lock(&MP_global_timeline);
+    ring = (modperl_timeline_ring_t *)modperl_global_get(&MP_global_timeline);
+    sampled = (ring->requests++ % scfg->timeline_sample) == 0;
+    modperl_global_unlock(&MP_global_timeline);
+
+    if (!sampled) {
+        return;
+    }
+
+    rcfg->timeline =
+        (modperl_timeline_t *)apr_palloc(r->pool, sizeof(*rcfg->timeline));
+    rcfg->timeline->start  = r->request_time ? r->request_time
+                                             : apr_time_now();
+    rcfg->timeline->events =
+        apr_array_make(r->pool, 16, sizeof(modperl_timeline_event_t));
+
+    apr_pool_cleanup_register(r->pool, (void *)r,
+                              modperl_timeline_store,
+                              apr_pool_cleanup_null);
+
+    MP_TRACE_g(MP_FUNC, "sampling request 0x%lx", (unsigned long)r);
+}
+
+/* the finished timelines, oldest first */
+SV *modperl_timeline_as_avrv(pTHX)
+{
+    AV *av = newAV();
+    modperl_timeline_ring_t *ring;
+    int i;
+
+    modperl_global_lock(&MP_global_timeline);
+
+    ring = (modperl_timeline_ring_t *)modperl_global_get(&MP_global_timeline);
+    for (i = 0; i < MP_TIMELINE_RING_SIZE; i++) {
+        char *record =
+            ring->records[(ring->next + i) % MP_TIMELINE_RING_SIZE];
+        if (record) {
+            av_push(av, newSVpv(record, 0));
+        }
+    }
+
+    modperl_global_unlock(&MP_global_timeline);
+
+    return newRV_noinc((SV *)av);
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,50 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODPERL_TIMELINE_H
+#define MODPERL_TIMELINE_H
+
+/*
+ * sampled request timelines: with PerlTimelineSample N one out of N
+ * requests records when it waited for an interpreter, ran Perl
+ * handlers and filters, set up %ENV and flushed its output.  finished
+ * timelines are kept as JSON records in a per-process ring buffer of
+ * MP_TIMELINE_RING_SIZE entries, see ModPerl::Util::timelines()
+ */
+
+#ifndef MP_TIMELINE_RING_SIZE
+#define MP_TIMELINE_RING_SIZE 128
+#endif
+
+void modperl_timeline_init(apr_pool_t *p);
+
+void modperl_timeline_sample(request_rec *r, modperl_config_req_t *rcfg);
+
+apr_time_t modperl_timeline_now(request_rec *r);
+
+void modperl_timeline_add(request_rec *r, const char *what,
+                          const char *name, apr_time_t start);
+
+SV *modperl_timeline_as_avrv(pTHX);
+
+#endif /* MODPERL_TIMELINE_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
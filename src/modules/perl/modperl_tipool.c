@@ -195,6 +195,112 @@ void modperl_tipool_init(modperl_tipool_t *tipool)
 
 }
 
+#if APR_HAS_THREADS
+
+/* one job per tipool: its items are grown one after another, since
+ * they are all made from the same data (for the interpreter pools,
+ * perl_clone() of the same parent, which writes to the parent while
+ * cloning it) */
+typedef struct {
+    apr_thread_mutex_t *mutex;
+    modperl_tipool_t **jobs;
+    int njobs;
+    int next;
+} modperl_tipool_jobs_t;
+
+static void modperl_tipool_jobs_run(modperl_tipool_jobs_t *jobs)
+{
+    for (;;) {
+        modperl_tipool_t *tipool;
+        int i;
+
+        apr_thread_mutex_lock(jobs->mutex);
+        tipool = jobs->next < jobs->njobs ? jobs->jobs[jobs->next++] : NULL;
+        apr_thread_mutex_unlock(jobs->mutex);
+
+        if (!tipool) {
+            break;
+        }
+
+        for (i = 0; i < tipool->cfg->start; i++) {
+            void *item =
+                (*tipool->func->tipool_sgrow)(tipool, tipool->data);
+
+            modperl_tipool_lock(tipool);
+            modperl_tipool_add(tipool, item);
+            modperl_tipool_unlock(tipool);
+        }
+    }
+}
+
+static void * APR_THREAD_FUNC modperl_tipool_jobs_thread(apr_thread_t *thd,
+                                                         void *data)
+{
+    modperl_tipool_jobs_run((modperl_tipool_jobs_t *)data);
+    apr_thread_exit(thd, APR_SUCCESS);
+    return NULL;
+}
+
+#endif /* APR_HAS_THREADS */
+
+/*
+ * same as calling modperl_tipool_init() for each of the tipools, but
+ * grows up to threads tipools at once.  the caller must make sure
+ * tipool_sgrow is safe to run concurrently for different tipools.
+ */
+void modperl_tipool_init_concurrent(apr_pool_t *p,
+                                    modperl_tipool_t **tipools, int n,
+                                    int threads)
+{
+    int i;
+#if APR_HAS_THREADS
+    modperl_tipool_jobs_t jobs;
+
+    if (threads > n) {
+        threads = n;
+    }
+
+    if (threads > 1 &&
+        apr_thread_mutex_create(&jobs.mutex, APR_THREAD_MUTEX_DEFAULT,
+                                p) == APR_SUCCESS) {
+        apr_thread_t **thds;
+        int nthds = 0;
+
+        jobs.jobs = tipools;
+        jobs.njobs = n;
+        jobs.next = 0;
+
+        /* the calling thread is one of the workers, so all jobs get
+         * done even if no thread could be created */
+        thds = (apr_thread_t **)apr_palloc(p, threads * sizeof(*thds));
+        for (i = 1; i < threads; i++) {
+            if (apr_thread_create(&thds[nthds], NULL,
+                                  modperl_tipool_jobs_thread,
+                                  &jobs, p) == APR_SUCCESS) {
+                nthds++;
+            }
+        }
+
+        modperl_tipool_jobs_run(&jobs);
+
+        for (i = 0; i < nthds; i++) {
+            apr_status_t rv;
+            apr_thread_join(&rv, thds[i]);
+        }
+
+        apr_thread_mutex_destroy(jobs.mutex);
+
+        MP_TRACE_i(MP_FUNC, "grew %d pools on %d threads",
+                   n, nthds + 1);
+        return;
+    }
+#endif /* APR_HAS_THREADS */
+
+    for (i = 0; i < n; i++) {
+        modperl_tipool_init(tipools[i]);
+    }
+}
+
 void modperl_tipool_destroy(modperl_tipool_t *tipool)
 {
     while (tipool->idle) {
@@ -41,6 +41,10 @@ modperl_tipool_t *modperl_tipool_new(apr_pool_t *p,
 
 void modperl_tipool_init(modperl_tipool_t *tipool);
 
+void modperl_tipool_init_concurrent(apr_pool_t *p,
+                                    modperl_tipool_t **tipools, int n,
+                                    int threads);
+
 void modperl_tipool_destroy(modperl_tipool_t *tipool);
 
 void modperl_tipool_add(modperl_tipool_t *tipool, void *data);
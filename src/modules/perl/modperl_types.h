@@ -63,6 +63,7 @@ struct modperl_interp_t {
     U8 flags;
     modperl_config_con_t *ccfg;
     int refcnt;
+    PTR_TBL_t *config_table; /* ModPerl::Module::ConfigTable */
 #ifdef MP_TRACE
     unsigned long tid;
 #endif
@@ -105,12 +106,17 @@ struct modperl_interp_pool_t {
     server_rec *server;
     modperl_tipool_t *tipool;
     modperl_interp_t *parent; /* from which to perl_clone() */
+    apr_hash_t *mgv_cache; /* resolved handlers, see modperl_mgv.c */
 };
 
 #endif /* USE_ITHREADS */
 
 typedef U32 modperl_opts_t;
 
+typedef struct modperl_timeline_t modperl_timeline_t;
+typedef struct modperl_module_config_memo_t modperl_module_config_memo_t;
+typedef struct modperl_table_index_t modperl_table_index_t;
+
 typedef struct {
     modperl_opts_t opts;
     modperl_opts_t opts_add;
@@ -123,9 +129,11 @@ typedef struct {
 typedef struct {
     MpHV *setvars;
     MpHV *configvars;
+    modperl_table_index_t *configvars_index;
     MpHV *SetEnv;
     MpHV *PassEnv;
     MpAV *PerlRequire, *PerlModule, *PerlPostConfigRequire;
+    MpAV *PerlWarmupHandler;
     MpAV *handlers_per_srv[MP_HANDLER_NUM_PER_SRV];
     MpAV *handlers_files[MP_HANDLER_NUM_FILES];
     MpAV *handlers_process[MP_HANDLER_NUM_PROCESS];
@@ -134,6 +142,7 @@ typedef struct {
 #ifdef USE_ITHREADS
     modperl_interp_pool_t *mip;
     modperl_tipool_config_t *interp_pool_cfg;
+    int interp_clone_threads;
 #else
     PerlInterpreter *perl;
 #endif
@@ -144,6 +153,8 @@ typedef struct {
     modperl_options_t *flags;
     apr_hash_t *modules;
     server_rec *server;
+    int timeline_sample;
+    int add_config_cache;
 } modperl_config_srv_t;
 
 typedef struct {
@@ -153,7 +164,9 @@ typedef struct {
     MpHV *SetEnv;
     MpHV *setvars;
     MpHV *configvars;
+    modperl_table_index_t *configvars_index; /* built on first use */
     modperl_options_t *flags;
+    apr_pool_t *pool;
 } modperl_config_dir_t;
 
 typedef struct {
@@ -253,6 +266,9 @@ typedef struct {
     MpAV *handlers_per_dir[MP_HANDLER_NUM_PER_DIR];
     MpAV *handlers_per_srv[MP_HANDLER_NUM_PER_SRV];
     modperl_perl_globals_t perl_globals;
+    modperl_timeline_t *timeline;
+    apr_array_header_t *log_fields;
+    modperl_module_config_memo_t *module_config_memo;
 } modperl_config_req_t;
 
 struct modperl_config_con_t {
@@ -19,6 +19,8 @@
 int modperl_require_module(pTHX_ const char *pv, int logfailure)
 {
     SV *sv;
+    modperl_startup_profile_entry_t *profile =
+        modperl_startup_profile_start(aTHX_ "module", pv);
 
     dSP;
     PUSHSTACKi(PERLSI_REQUIRE);
@@ -32,6 +34,8 @@ int modperl_require_module(pTHX_ const char *pv, int logfailure)
     POPSTACK;
     FREETMPS;LEAVE;
 
+    modperl_startup_profile_stop(aTHX_ profile, !SvTRUE(ERRSV));
+
     if (SvTRUE(ERRSV)) {
         if (logfailure) {
             (void)modperl_errsv(aTHX_ HTTP_INTERNAL_SERVER_ERROR,
@@ -45,8 +49,13 @@ int modperl_require_module(pTHX_ const char *pv, int logfailure)
 
 int modperl_require_file(pTHX_ const char *pv, int logfailure)
 {
+    modperl_startup_profile_entry_t *profile =
+        modperl_startup_profile_start(aTHX_ "file", pv);
+
     require_pv(pv);
 
+    modperl_startup_profile_stop(aTHX_ profile, !SvTRUE(ERRSV));
+
     if (SvTRUE(ERRSV)) {
         if (logfailure) {
             (void)modperl_errsv(aTHX_ HTTP_INTERNAL_SERVER_ERROR,
@@ -322,57 +331,49 @@ void modperl_xs_dl_handles_close(void **handles)
     free(handles);
 }
 
-/* XXX: There is no XS accessible splice() */
-static void modperl_av_remove_entry(pTHX_ AV *av, I32 index)
+/* remove all the entries of @dl_modules listed in the packages hash,
+ * closing their handles, with the matching @dl_librefs entries. it's a
+ * single pass over the arrays which compacts them in place, rather
+ * than a scan and a splice per unloaded package. returns the number
+ * of closed handles */
+static I32 modperl_package_unload_dynamic(pTHX_ HV *packages)
 {
-    I32 i;
-    AV *tmpav = newAV();
-
-    /* stash the entries _before_ the item to delete */
-    for (i=0; i<=index; i++) {
-        av_store(tmpav, i, SvREFCNT_inc(av_shift(av)));
-    }
-
-    /* make size at the beginning of the array */
-    av_unshift(av, index-1);
+    I32 i, j, fill, closed = 0;
+    AV *librefs = get_av(dl_librefs, FALSE);
+    AV *modules = get_av(dl_modules, FALSE);
 
-    /* add stashed entries back */
-    for (i=0; i<index; i++) {
-        av_store(av, i, *av_fetch(tmpav, i, 0));
+    if (!(librefs && modules)) {
+        return 0;
     }
 
-    sv_free((SV *)tmpav);
-}
-
-static void modperl_package_unload_dynamic(pTHX_ const char *package,
-                                           I32 dl_index)
-{
-    AV *librefs = get_av(dl_librefs, 0);
-    SV *libref = *av_fetch(librefs, dl_index, 0);
-
-    modperl_sys_dlclose(INT2PTR(void *, SvIV(libref)));
+    fill = AvFILL(modules);
 
-    /* remove package from @dl_librefs and @dl_modules */
-    modperl_av_remove_entry(aTHX_ get_av(dl_librefs, 0), dl_index);
-    modperl_av_remove_entry(aTHX_ get_av(dl_modules, 0), dl_index);
+    for (i = 0, j = 0; i <= fill; i++) {
+        SV **module = av_fetch(modules, i, FALSE);
+        SV **libref = av_fetch(librefs, i, FALSE);
 
-    return;
-}
+        if (module && *module && hv_exists_ent(packages, *module, 0)) {
+            if (libref && *libref) {
+                MP_TRACE_r(MP_FUNC, "dlclose %s", SvPV_nolen(*module));
+                modperl_sys_dlclose(INT2PTR(void *, SvIV(*libref)));
+            }
+            closed++;
+            continue;
+        }
 
-static int modperl_package_is_dynamic(pTHX_ const char *package,
-                                      I32 *dl_index)
-{
-   I32 i;
-   AV *modules = get_av(dl_modules, FALSE);
-
-   for (i=0; i<av_len(modules); i++) {
-        SV *module = *av_fetch(modules, i, 0);
-        if (strEQ(package, SvPVX(module))) {
-            *dl_index = i;
-            return TRUE;
+        if (i != j) {
+            av_store(modules, j, module ? SvREFCNT_inc(*module) : newSV(0));
+            av_store(librefs, j, libref ? SvREFCNT_inc(*libref) : newSV(0));
         }
+        j++;
+    }
+
+    if (closed) {
+        av_fill(modules, j - 1);
+        av_fill(librefs, j - 1);
     }
-    return FALSE;
+
+    return closed;
 }
 
 modperl_cleanup_data_t *modperl_cleanup_data_new(apr_pool_t *p, void *data)
@@ -505,6 +506,24 @@ MP_INLINE SV *modperl_dir_config(pTHX_ request_rec *r, server_rec *s,
 {
     SV *retval = &PL_sv_undef;
 
+    if (key && !sv_val) { /* the common $r->dir_config('Key') case */
+        const char *val = NULL;
+
+        if (r && r->per_dir_config) {
+            MP_dDCFG;
+            modperl_table_index_t *idx = modperl_config_dir_index_get(dcfg);
+            val = modperl_table_index_get(idx, dcfg->configvars, key);
+        }
+
+        if (!val && s && s->module_config) {
+            MP_dSCFG(s);
+            val = modperl_table_index_get(scfg->configvars_index,
+                                          scfg->configvars, key);
+        }
+
+        return val ? newSVpv(val, 0) : newSV(0);
+    }
+
     if (r && r->per_dir_config) {
         MP_dDCFG;
         retval = modperl_table_get_set(aTHX_ dcfg->configvars,
@@ -560,6 +579,136 @@ SV *modperl_table_get_set(pTHX_ apr_table_t *table, char *key,
     return retval;
 }
 
+typedef struct {
+    apr_uint32_t hash;
+    int pos;
+} modperl_table_index_slot_t;
+
+/*
+ * apr tables can be modified by any C or Perl code holding them, so
+ * the index remembers what the table looked like when it was built:
+ * any add/set of a new key appends a new entry (changing nelts and
+ * the last key), any unset shifts the entries (changing nelts), and a
+ * reallocation moves elts.  a set of an existing key changes its value
+ * in place, which is fine since only positions are indexed.  a lookup
+ * never returns an entry whose key doesn't match.
+ */
+struct modperl_table_index_t {
+    const apr_table_entry_t *elts;
+    int nelts;
+    const char *first;
+    const char *last;
+    apr_uint32_t mask;
+    modperl_table_index_slot_t *slots;
+};
+
+static apr_uint32_t modperl_table_index_hash(const char *key)
+{
+    apr_uint32_t hash = 0;
+
+    for (; *key; key++) {
+        hash = hash * 33 + (unsigned char)apr_tolower(*key);
+    }
+
+    return hash;
+}
+
+modperl_table_index_t *modperl_table_index_make(apr_pool_t *p,
+                                                const apr_table_t *t)
+{
+    const apr_array_header_t *arr;
+    const apr_table_entry_t *elts;
+    modperl_table_index_t *idx;
+    apr_uint32_t size;
+    int i;
+
+    if (!t) {
+        return NULL;
+    }
+
+    arr = apr_table_elts(t);
+    if (arr->nelts < MP_TABLE_INDEX_MIN) {
+        return NULL;
+    }
+
+    elts = (const apr_table_entry_t *)arr->elts;
+
+    /* keep the load factor under 1/2 */
+    for (size = 16; size < (apr_uint32_t)arr->nelts * 2; size <<= 1)
+        ;
+
+    idx = (modperl_table_index_t *)apr_palloc(p, sizeof(*idx));
+    idx->elts  = elts;
+    idx->nelts = arr->nelts;
+    idx->first = elts[0].key;
+    idx->last  = elts[arr->nelts - 1].key;
+    idx->mask  = size - 1;
+    idx->slots = (modperl_table_index_slot_t *)
+        apr_palloc(p, size * sizeof(*idx->slots));
+
+    for (i = 0; i < (int)size; i++) {
+        idx->slots[i].pos = -1;
+    }
+
+    for (i = 0; i < arr->nelts; i++) {
+        apr_uint32_t hash, n;
+
+        if (!elts[i].key) {
+            continue;
+        }
+
+        hash = modperl_table_index_hash(elts[i].key);
+
+        for (n = hash & idx->mask; idx->slots[n].pos >= 0;
+             n = (n + 1) & idx->mask) {
+            if (idx->slots[n].hash == hash &&
+                !strcasecmp(elts[idx->slots[n].pos].key, elts[i].key)) {
+                break; /* apr_table_get() returns the first value */
+            }
+        }
+
+        if (idx->slots[n].pos < 0) {
+            idx->slots[n].hash = hash;
+            idx->slots[n].pos  = i;
+        }
+    }
+
+    return idx;
+}
+
+const char *modperl_table_index_get(const modperl_table_index_t *idx,
+                                    const apr_table_t *t, const char *key)
+{
+    const apr_array_header_t *arr;
+    const apr_table_entry_t *elts;
+    apr_uint32_t hash, n;
+
+    if (!t) {
+        return NULL;
+    }
+
+    arr  = apr_table_elts(t);
+    elts = (const apr_table_entry_t *)arr->elts;
+
+    if (!idx || idx->elts != elts || idx->nelts != arr->nelts ||
+        idx->first != elts[0].key || idx->last != elts[arr->nelts - 1].key) {
+        return apr_table_get(t, key);
+    }
+
+    hash = modperl_table_index_hash(key);
+
+    for (n = hash & idx->mask; idx->slots[n].pos >= 0;
+         n = (n + 1) & idx->mask) {
+        const apr_table_entry_t *elt = &elts[idx->slots[n].pos];
+        if (idx->slots[n].hash == hash && elt->key &&
+            !strcasecmp(elt->key, key)) {
+            return elt->val;
+        }
+    }
+
+    return NULL;
+}
+
 static char *package2filename(const char *package, int *len)
 {
     const char *s;
@@ -758,42 +907,199 @@ static void modperl_package_delete_from_inc(pTHX_ const char *package)
                                      (key[1] == '<'))
 #define MP_SAFE_STASH(key, len)     (!(MP_STASH_SUBSTASH(key,len)|| \
                                       (MP_STASH_DEBUGGER(key, len))))
-static void modperl_package_clear_stash(pTHX_ const char *package)
+static I32 modperl_package_clear_stash(pTHX_ HV *stash)
+{
+    HE *he;
+    I32 len, deleted = 0;
+    char *key;
+
+    hv_iterinit(stash);
+    while ((he = hv_iternext(stash))) {
+        key = hv_iterkey(he, &len);
+        if (MP_SAFE_STASH(key, len)) {
+            SV *val = hv_iterval(stash, he);
+            /* The safe thing to do is to skip over stash entries
+             * that don't come from the package we are trying to
+             * unload
+             */
+            if (GvSTASH(val) == stash) {
+                (void)hv_delete(stash, key, len, G_DISCARD);
+                deleted++;
+            }
+        }
+    }
+
+    return deleted;
+}
+
+/* add the package and, if tree is true, all its sub-packages to the
+ * packages hash (name => stash) */
+static void modperl_package_collect(pTHX_ HV *packages, HV *stash, int tree)
+{
+    HE *he;
+    I32 len;
+    char *key;
+    const char *name = HvNAME(stash);
+
+    if (!name || hv_exists(packages, name, strlen(name))) {
+        return;
+    }
+
+    (void)hv_store(packages, name, strlen(name), newSViv(PTR2IV(stash)), 0);
+
+    if (!tree) {
+        return;
+    }
+
+    hv_iterinit(stash);
+    while ((he = hv_iternext(stash))) {
+        key = hv_iterkey(he, &len);
+        if (MP_STASH_SUBSTASH(key, len)) {
+            SV *val = hv_iterval(stash, he);
+            HV *substash;
+            if (isGV(val) && (substash = GvHV((GV *)val)) &&
+                substash != stash) {
+                modperl_package_collect(aTHX_ packages, substash, tree);
+            }
+        }
+    }
+}
+
+typedef struct {
+    apr_uint64_t calls;
+    apr_uint64_t packages;
+    apr_uint64_t symbols;
+    apr_uint64_t dl_closed;
+    apr_interval_time_t time;
+} modperl_package_unload_stats_t;
+
+static modperl_global_t MP_global_unload_stats;
+
+void modperl_package_unload_init(apr_pool_t *p)
 {
-    HV *stash;
+    modperl_package_unload_stats_t *stats =
+        (modperl_package_unload_stats_t *)apr_pcalloc(p, sizeof(*stats));
+
+    modperl_global_init(&MP_global_unload_stats, p, (void *)stats,
+                        "unload_stats");
+}
+
+static void modperl_package_unload_do(pTHX_ const char *package, int tree)
+{
+    HV *stash, *packages;
+    HE *he;
+    I32 npackages, symbols = 0, closed;
+    apr_time_t start = apr_time_now();
+    modperl_package_unload_stats_t *stats;
+
+    packages = newHV();
+
     if ((stash = gv_stashpv(package, FALSE))) {
-        HE *he;
+        modperl_package_collect(aTHX_ packages, stash, tree);
+    }
+    else {
+        /* no stash, but it might still be in %INC and @dl_modules */
+        (void)hv_store(packages, package, strlen(package), newSViv(0), 0);
+    }
+
+    npackages = HvKEYS(packages);
+
+    hv_iterinit(packages);
+    while ((he = hv_iternext(packages))) {
         I32 len;
-        char *key;
-        hv_iterinit(stash);
-        while ((he = hv_iternext(stash))) {
-            key = hv_iterkey(he, &len);
-            if (MP_SAFE_STASH(key, len)) {
-                SV *val = hv_iterval(stash, he);
-                /* The safe thing to do is to skip over stash entries
-                 * that don't come from the package we are trying to
-                 * unload
-                 */
-                if (GvSTASH(val) == stash) {
-                    (void)hv_delete(stash, key, len, G_DISCARD);
-                }
-            }
+        char *name = hv_iterkey(he, &len);
+        IV iv = SvIV(hv_iterval(packages, he));
+
+        MP_TRACE_r(MP_FUNC, "unloading %s", name);
+
+        if (iv) {
+            symbols += modperl_package_clear_stash(aTHX_ INT2PTR(HV *, iv));
         }
+        modperl_package_delete_from_inc(aTHX_ name);
+    }
+
+    closed = modperl_package_unload_dynamic(aTHX_ packages);
+
+    SvREFCNT_dec((SV *)packages);
+
+    modperl_global_lock(&MP_global_unload_stats);
+    stats = (modperl_package_unload_stats_t *)
+        modperl_global_get(&MP_global_unload_stats);
+    if (stats) {
+        stats->calls++;
+        stats->packages  += npackages;
+        stats->symbols   += symbols;
+        stats->dl_closed += closed;
+        stats->time      += apr_time_now() - start;
     }
+    modperl_global_unlock(&MP_global_unload_stats);
 }
 
 /* Unload a module as completely and cleanly as possible */
 void modperl_package_unload(pTHX_ const char *package)
 {
-    I32 dl_index;
+    modperl_package_unload_do(aTHX_ package, FALSE);
+}
+
+/* Same as modperl_package_unload, but unloads all the sub-packages of
+ * package (e.g. Foo::Bar and Foo::Bar::Baz for Foo) in the same pass */
+void modperl_package_unload_tree(pTHX_ const char *package)
+{
+    modperl_package_unload_do(aTHX_ package, TRUE);
+}
 
-    modperl_package_clear_stash(aTHX_ package);
-    modperl_package_delete_from_inc(aTHX_ package);
+#define MP_UNLOAD_STATS_STORE(key)                                  \
+    (void)hv_store(hv, #key, sizeof(#key) - 1,                      \
+                   newSVnv((NV)stats->key), 0)
 
-    if (modperl_package_is_dynamic(aTHX_ package, &dl_index)) {
-        modperl_package_unload_dynamic(aTHX_ package, dl_index);
+/* returns { calls, packages, symbols, dl_closed, time } for all the
+ * modperl_package_unload{,_tree} calls made by this process, the
+ * time is in microseconds */
+SV *modperl_package_unload_stats(pTHX)
+{
+    HV *hv = newHV();
+    modperl_package_unload_stats_t *stats;
+
+    modperl_global_lock(&MP_global_unload_stats);
+    stats = (modperl_package_unload_stats_t *)
+        modperl_global_get(&MP_global_unload_stats);
+    if (stats) {
+        MP_UNLOAD_STATS_STORE(calls);
+        MP_UNLOAD_STATS_STORE(packages);
+        MP_UNLOAD_STATS_STORE(symbols);
+        MP_UNLOAD_STATS_STORE(dl_closed);
+        MP_UNLOAD_STATS_STORE(time);
+    }
+    modperl_global_unlock(&MP_global_unload_stats);
+
+    return newRV_noinc((SV *)hv);
+}
+
+/* str as a quoted JSON string */
+const char *modperl_json_str(apr_pool_t *p, const char *str)
+{
+    apr_size_t len = strlen(str);
+    char *buf = apr_palloc(p, len * 6 + 3);
+    char *d = buf;
+
+    *d++ = '"';
+    for (; *str; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\') {
+            *d++ = '\\';
+            *d++ = c;
+        }
+        else if (c < 0x20) {
+            d += apr_snprintf(d, 7, "\\u%04x", c);
+        }
+        else {
+            *d++ = c;
+        }
     }
+    *d++ = '"';
+    *d = '\0';
 
+    return buf;
 }
 
 #define MP_RESTART_COUNT_KEY "mod_perl_restart_count"
@@ -836,7 +1142,7 @@ apr_status_t modperl_cleanup_pnotes(void *data) {
     dTHXa(pnotes->interp->perl);
     MP_ASSERT_CONTEXT(aTHX);
 
-    SvREFCNT_dec(pnotes->pnotes);
+    modperl_arena_hv_release(aTHX_ pnotes->pnotes);
     pnotes->pnotes = NULL;
     pnotes->pool = NULL;
 
@@ -865,7 +1171,7 @@ SV *modperl_pnotes(pTHX_ modperl_pnotes_t *pnotes, SV *key, SV *val,
         MP_TRACE_i(MP_FUNC, "TO: (0x%lx)->refcnt incremented to %ld",
                    pnotes->interp, pnotes->interp->refcnt);
 #endif
-        pnotes->pnotes = newHV();
+        pnotes->pnotes = modperl_arena_hv(aTHX);
         apr_pool_cleanup_register(pool, pnotes,
                                   modperl_cleanup_pnotes,
                                   apr_pool_cleanup_null);
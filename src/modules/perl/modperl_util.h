@@ -85,6 +85,30 @@ MP_INLINE SV *modperl_dir_config(pTHX_ request_rec *r, server_rec *s,
 SV *modperl_table_get_set(pTHX_ apr_table_t *table, char *key,
                           SV *sv_val, int do_taint);
 
+/* tables with fewer entries are scanned faster than hashed */
+#define MP_TABLE_INDEX_MIN 8
+
+/**
+ * build a read-only hashed index of a table's keys, so a lookup
+ * doesn't need to scan the table
+ * @param p    pool to allocate the index from
+ * @param t    table to index
+ * @return the index, or NULL if the table is too small to bother
+ */
+modperl_table_index_t *modperl_table_index_make(apr_pool_t *p,
+                                                const apr_table_t *t);
+
+/**
+ * same as apr_table_get(), but uses the index when it still matches
+ * the table and falls back to a table scan if it was modified since
+ * @param idx  index built by modperl_table_index_make() (or NULL)
+ * @param t    the indexed table
+ * @param key  key to look up (case-insensitive)
+ * @return the first value of key or NULL
+ */
+const char *modperl_table_index_get(const modperl_table_index_t *idx,
+                                    const apr_table_t *t, const char *key);
+
 MP_INLINE int modperl_perl_module_loaded(pTHX_ const char *name);
 
 /**
@@ -101,6 +125,15 @@ SV *modperl_apr_array_header2avrv(pTHX_ apr_array_header_t *array);
 apr_array_header_t *modperl_avrv2apr_array_header(pTHX_ apr_pool_t *p,
                                                   SV *avrv);
 void modperl_package_unload(pTHX_ const char *package);
+
+void modperl_package_unload_tree(pTHX_ const char *package);
+
+void modperl_package_unload_init(apr_pool_t *p);
+
+SV *modperl_package_unload_stats(pTHX);
+
+const char *modperl_json_str(apr_pool_t *p, const char *str);
+
 #if defined(MP_TRACE) && defined(USE_ITHREADS)
 #define MP_TRACEf_PERLID   "perl id 0x%lx"
 #define MP_TRACEv_PERLID   (unsigned long)my_perl
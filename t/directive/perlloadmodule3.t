@@ -15,7 +15,7 @@ my $path = Apache::TestRequest::module2path($module);
 # smaller portions of information, but requires a more elaborate
 # logic. Alternatively could use diff($expected, $received).
 
-plan tests => 3;
+plan tests => 4;
 
 t_debug("connecting to $base_hostport");
 {
@@ -96,4 +96,8 @@ EOI
     my $location = "http://$hostport/$path/subdir";
     my $received = GET_BODY $location;
     ok t_cmp($received, $expected, "server/dir/subdir merge");
+
+    # the request time merges are memoized now
+    $received = GET_BODY $location;
+    ok t_cmp($received, $expected, "server/dir/subdir merge (memoized)");
 }
@@ -0,0 +1,27 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+use Apache::TestRequest 'GET_BODY';
+
+plan tests => 5, need_lwp;
+
+my $module = 'TestDirective::perltimelinesample';
+
+Apache::TestRequest::user_agent(reset => 1, keep_alive => 1);
+my $url = Apache::TestRequest::module2url($module);
+
+t_debug("connecting to $url");
+ok t_cmp GET_BODY($url), 'ok', 'sampled request';
+
+my $record = GET_BODY("$url?dump");
+t_debug($record);
+
+ok t_cmp $record, qr/^\{"pid":\d+,/, 'got a timeline record';
+ok t_cmp $record, qr/"method":"GET"/, 'request method';
+ok t_cmp $record, qr/"what":"phase","name":"PerlFixupHandler"/,
+    'fixup phase';
+ok t_cmp $record, qr/"what":"phase","name":"PerlResponseHandler"/,
+    'response phase';
@@ -0,0 +1,127 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestAPRlib::shmcache;
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use APR::Pool ();
+
+my $procs = 4;
+my $incrs = 200;
+
+sub num_of_tests {
+    return 24;
+}
+
+sub test {
+
+    require APR::SHMCache;
+
+    my $pool = APR::Pool->new();
+    my $cache = APR::SHMCache->new($pool, size => 1 << 20, stripes => 4,
+                                   page_size => 8192);
+
+    ok $cache;
+
+    ok $cache->set(foo => "bar\0baz");
+    ok t_cmp($cache->get('foo'), "bar\0baz", 'get');
+    ok !defined $cache->get('nope');
+
+    my ($val, $cas) = $cache->gets('foo');
+    ok t_cmp($val, "bar\0baz", 'gets');
+
+    ok !$cache->cas(foo => 'new', $cas + 1);
+    ok $cache->cas(foo => 'new', $cas);
+    ok !$cache->cas(foo => 'newer', $cas);
+
+    # larger than half a page
+    ok !$cache->set(big => 'x' x 5000);
+
+    ok $cache->delete('foo');
+    ok !defined $cache->get('foo');
+
+    ok t_cmp($cache->stats->{items}, 0, 'stats');
+
+    # the segment holds bytes
+    {
+        my $latin1 = "caf\x{e9}";
+        utf8::upgrade($latin1);
+        ok $cache->set(latin1 => $latin1);
+        ok t_cmp($cache->get('latin1'), "caf\x{e9}", 'latin-1 chars');
+
+        eval { $cache->set(wide => "\x{263a}") };
+        ok t_cmp($@, qr/wide character/, 'wide chars');
+    }
+
+    # expiry
+    {
+        ok $cache->set(ttl => 'soon gone', 1);
+        ok t_cmp($cache->get('ttl'), 'soon gone', 'before the ttl');
+        sleep 2;
+        ok !defined $cache->get('ttl');
+        t_debug "expired: " . $cache->stats->{expired};
+    }
+
+    # one stripe with a few pages of 1k
+    my $small = APR::SHMCache->new($pool, size => 8192, stripes => 1,
+                                   page_size => 1024);
+
+    # a full class evicts the entries not read since the clock hand's
+    # last pass, 'hot' is read after each set and stays
+    {
+        $small->set(hot => 1);
+        for my $i (0..199) {
+            $small->set(sprintf("k%03d", $i) => 'x' x 10);
+            $small->get('hot');
+        }
+        my $stats = $small->stats;
+        t_debug "items: $stats->{items}, evictions: $stats->{evictions}";
+        ok $stats->{evictions} > 0;
+        ok t_cmp($small->get('hot'), 1, 'referenced entry kept');
+        ok !defined $small->get('k000');
+    }
+
+    # a class with no page takes one from the class with most pages
+    {
+        my $before = $small->stats;
+        ok $small->set(large => 'y' x 400);
+        my $after = $small->stats;
+        t_debug "items: $before->{items} -> $after->{items}";
+        ok $after->{items} < $before->{items}
+            && t_cmp($small->get('large'), 'y' x 400, 'page stolen');
+    }
+
+    # the processes forked after the cache was created share it: they
+    # all increment one counter with cas(), retrying when another one
+    # got in between
+    if ($ENV{MOD_PERL} || $^O eq 'MSWin32') {
+        skip "no fork", 0;
+    }
+    else {
+        $cache->set(counter => 0);
+        my @pids;
+        for (1..$procs) {
+            my $pid = fork;
+            die "fork: $!" unless defined $pid;
+            if ($pid) {
+                push @pids, $pid;
+                next;
+            }
+            for (1..$incrs) {
+                while (1) {
+                    my ($n, $cas) = $cache->gets('counter');
+                    last if $cache->cas(counter => $n + 1, $cas);
+                }
+            }
+            CORE::exit(0);
+        }
+        waitpid $_, 0 for @pids;
+        ok t_cmp($cache->get('counter'), $procs * $incrs,
+                 'incremented by all the children');
+    }
+}
+
+1;
@@ -18,7 +18,7 @@ use constant TABLE_SIZE => 20;
 our $filter_count;
 
 sub num_of_tests {
-    my $tests = 56;
+    my $tests = 65;
 
     # tied hash values() for a table w/ multiple values for the same
     # key
@@ -357,6 +357,52 @@ sub test {
         ok t_cmp $table->get("a"), 5, "no segfault";
     }
 
+    # tied access to big tables goes through a side index
+    {
+        my $table = APR::Table::make($pool, 100);
+        $table->add("Key-$_" => $_) for 1..100;
+        $table->add("KEY-1" => "dup");
+
+        ok t_cmp join(",", map { $table->{"key-$_"} } 1, 50, 100),
+            "1,50,100", "FETCH from a big table";
+        ok t_cmp((exists $table->{"KEY-77"}) && !(exists $table->{"Key-0"}),
+            1, "EXISTS in a big table");
+
+        # the index must notice the changes
+        $table->unset("Key-50");
+        $table->add("Key-101" => 101);
+        ok t_cmp join(",", map { defined $_ ? $_ : "undef" }
+                 map { $table->{"key-$_"} } 50, 101),
+            "undef,101", "FETCH after unset/add";
+
+        $table->set("Key-1" => "one");
+        ok t_cmp $table->{"key-1"}, "one", "FETCH after set";
+
+        $table->compress(APR::Const::OVERLAP_TABLES_MERGE);
+        ok t_cmp join(",", map { $table->{"key-$_"} } 1, 2, 101),
+            "one,2,101", "FETCH after compress";
+    }
+
+    # bulk export/import
+    {
+        my $table = APR::Table::make($pool, 10);
+        $table->add_pairs([a => 1, b => 2, A => 3]);
+
+        ok t_cmp join(",", @{ $table->to_pairs }), "a,1,b,2,A,3",
+            "add_pairs/to_pairs keep the order and the duplicates";
+
+        my $hash = $table->to_hash;
+        ok t_cmp join(",", map { "$_=$hash->{$_}" } sort keys %$hash),
+            "a=1,b=2", "to_hash: the first value wins";
+
+        $table->merge_from_hash({ a => undef, b => [4, 5], c => 6 });
+        ok t_cmp join(",", sort @{ $table->to_pairs }), "4,5,6,b,b,c",
+            "merge_from_hash";
+
+        eval { $table->add_pairs([1]) };
+        ok t_cmp $@, qr/odd number of elements/, "add_pairs: odd list";
+    }
+
 }
 
 sub my_filter {
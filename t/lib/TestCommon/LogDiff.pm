@@ -34,6 +34,10 @@ sub diff {
     # XXX: is it possible that some system will be slow to flush the
     # buffers and we may need to wait a bit and retry if we see no new
     # logged data?
+
+    # messages queued under PerlLogAsync aren't in the file yet
+    Apache2::Log::async_flush() if defined &Apache2::Log::async_flush;
+
     my $fh = $self->{fh};
     seek $fh, $self->{pos}, POSIX::SEEK_SET(); # not really needed
 
@@ -88,6 +88,18 @@ sub fixup {
     };
     $r->pnotes(add_config4 => "$@");
 
+    # directives handed over as [name, args] nodes
+    eval {
+        $r->add_config(['PerlSetVar AddConfigText text',
+                        ['PerlSetVar', 'AddConfigNode node']]);
+    };
+    $r->pnotes(add_config5 => "$@");
+
+    eval {
+        $r->add_config([['PerlSetVar']]);
+    };
+    $r->pnotes(add_config6 => "$@");
+
     return Apache2::Const::DECLINED;
 }
 
@@ -95,12 +107,16 @@ sub handler : method {
     my ($self, $r) = @_;
     my $cf = $self->get_config($r->server);
 
-    plan $r, tests => 9;
+    plan $r, tests => 12;
 
     ok t_cmp $r->pnotes('add_config1'), qr/.+\n/;
     ok t_cmp $r->pnotes('add_config2'), (APACHE22 ? qr/.+\n/ : '');
     ok t_cmp $r->pnotes('add_config3'), '';
     ok t_cmp $r->pnotes('add_config4'), qr/after server startup/;
+    ok t_cmp $r->pnotes('add_config5'), '';
+    ok t_cmp $r->dir_config('AddConfigText') . $r->dir_config('AddConfigNode'),
+        'textnode';
+    ok t_cmp $r->pnotes('add_config6'), qr/config node must be/;
     if (!APACHE24) {
         ok t_cmp $r->pnotes('followsymlinks'), (APACHE22 ? '': qr/.*\n/);
     }
@@ -0,0 +1,72 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestAPI::add_config_cache;
+
+# $r->add_config with PerlAddConfigCache 64 in this vhost only: the
+# same lines added again are found in the cache, and so is their
+# merge into the server's lookup_defaults, which is the per-dir
+# config of a subrequest at map_to_storage.  lines added once the
+# cache is full are still applied, just not cached
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache2::RequestRec ();
+use Apache2::RequestUtil ();
+use Apache2::SubRequest ();
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use Apache2::Const -compile => qw(OK DECLINED);
+
+use constant CACHE_SIZE => 64;
+
+sub map2storage {
+    my $r = shift;
+
+    return Apache2::Const::DECLINED if $r->is_initial_req;
+
+    $r->add_config(['PerlSetVar AddConfigCached cached',
+                    'PerlSetVar AddConfigMerged merged'], -1);
+
+    return Apache2::Const::DECLINED;
+}
+
+sub handler {
+    my $r = shift;
+
+    plan $r, tests => 4;
+
+    # the first subrequest fills the cache, the others hit it
+    for my $i (1..3) {
+        my $subr = $r->lookup_uri($r->uri);
+        ok t_cmp join(",", map { $subr->dir_config($_) }
+                           qw(AddConfigCached AddConfigMerged)),
+            "cached,merged",
+            "add_config in subrequest $i";
+    }
+
+    # more distinct lines than the cache can hold
+    my @n = 1..CACHE_SIZE + 1;
+    $r->add_config(["PerlSetVar AddConfigFill$_ $_"]) for @n;
+    ok t_cmp join(",", map { $r->dir_config("AddConfigFill$_") } @n),
+        join(",", @n),
+        'add_config past PerlAddConfigCache';
+
+    Apache2::Const::OK;
+}
+
+1;
+__END__
+<NoAutoConfig>
+<VirtualHost TestAPI::add_config_cache>
+    PerlAddConfigCache 64
+
+    PerlMapToStorageHandler TestAPI::add_config_cache::map2storage
+
+    <Location /TestAPI__add_config_cache>
+        SetHandler modperl
+        PerlResponseHandler TestAPI::add_config_cache
+    </Location>
+</VirtualHost>
+</NoAutoConfig>
@@ -30,7 +30,7 @@ sub handler {
     my $r = shift;
     my $s = $r->server;
 
-    plan $r, tests => (@LogLevels * 2) + 20;
+    plan $r, tests => (@LogLevels * 2) + 26;
 
     my $logdiff = TestCommon::LogDiff->new($path);
 
@@ -276,6 +276,54 @@ sub handler {
             'overriden via export warn()';
     }
 
+    # lazy formatting
+    {
+        ok t_cmp $rlog->is_enabled(Apache2::Const::LOG_EMERG), 1,
+            '$r->log->is_enabled(LOG_EMERG)';
+
+        t_server_log_error_is_expected();
+        $rlog->error(sub { join " ", "lazy", @_ }, "error", "test");
+        ok t_cmp $logdiff->diff,
+            qr/lazy error test/,
+            '$rlog->error(sub { }, @args)';
+
+        # the closure isn't called for a level below LogLevel
+        my $orig_log_level = $s->loglevel;
+        $s->loglevel(Apache2::Const::LOG_ERR)
+            unless Apache2::MPM->is_threaded;
+        if (!$rlog->is_enabled(Apache2::Const::LOG_DEBUG)) {
+            my $called = 0;
+            $rlog->debug(sub { $called++; "lazy debug test" });
+            ok t_cmp $called, 0, '$rlog->debug(sub { }) below LogLevel';
+        }
+        else {
+            skip "LogLevel debug can't be lowered under a threaded mpm", 0;
+        }
+        $s->loglevel($orig_log_level);
+    }
+
+    # PerlLogAsync 256: the message is queued and written by the
+    # writer thread, async_flush() waits for it to reach the error_log
+    {
+        my $before = Apache2::Log::async_stats();
+        t_server_log_warn_is_expected();
+        $rlog->warn("async test");
+        Apache2::Log::async_flush();
+        ok t_cmp $logdiff->diff,
+            qr/\[client [^]]+\] async test/,
+            '$rlog->warn() w/ PerlLogAsync';
+
+        my $after = Apache2::Log::async_stats();
+        if ($after->{size}) {
+            ok t_cmp $after->{size}, 256, 'async_stats size';
+            ok $after->{written} > $before->{written};
+        }
+        else {
+            # no threads, the message was logged synchronously
+            skip "PerlLogAsync needs threads", 0 for 1..2;
+        }
+    }
+
     Apache2::Const::OK;
 }
 
@@ -0,0 +1,45 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestAPI::log_fields;
+
+# structured per-request log fields
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache2::RequestRec ();
+use Apache2::ServerRec ();
+use Apache2::Log ();
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use Apache2::Const -compile => 'OK';
+
+sub handler {
+    my $r = shift;
+
+    plan $r, tests => 4;
+
+    my $log = $r->log;
+
+    ok t_cmp $log->fields_json, undef, "no fields";
+
+    my $str = "007";
+    $log->field(id => $str, count => 3, ratio => 0.5, user => undef);
+    $log->field(quote => qq{say "hi"\n});
+    ok t_cmp $log->fields_json,
+        '{"id":"007","count":3,"ratio":0.5,"user":null,' .
+        '"quote":"say \"hi\"\u000a"}',
+        "typed fields";
+
+    $log->field(count => 4);
+    ok t_cmp $log->fields_json, qr/"count":4,/, "the last value wins";
+
+    eval { $r->server->log->field(foo => 1) };
+    ok t_cmp $@, qr/require an Apache2::Log::Request/,
+        "no fields for server logs";
+
+    Apache2::Const::OK;
+}
+
+1;
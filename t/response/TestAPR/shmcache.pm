@@ -0,0 +1,25 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestAPR::shmcache;
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use Apache2::Const -compile => 'OK';
+
+use TestAPRlib::shmcache;
+
+sub handler {
+    my $r = shift;
+
+    my $tests = TestAPRlib::shmcache::num_of_tests();
+    plan $r, tests => $tests;
+
+    TestAPRlib::shmcache::test();
+
+    Apache2::Const::OK;
+}
+
+1;
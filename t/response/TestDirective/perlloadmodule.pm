@@ -104,7 +104,7 @@ sub handler : method {
     my $dir_cfg = $self->get_config($s, $r->per_dir_config);
     my $srv_cfg = $self->get_config($s);
 
-    plan $r, tests => 9;
+    plan $r, tests => 13;
 
     t_debug("per-dir config:", $dir_cfg);
     t_debug("per-srv config:", $srv_cfg);
@@ -133,6 +133,21 @@ sub handler : method {
 
     ok t_cmp($srv_cfg->{ServerTest}, 'per-server');
 
+    # repeated lookups within the request give the same objects
+    ok t_cmp("" . $self->get_config($s, $r->per_dir_config), "$dir_cfg",
+             'repeated per-dir get_config');
+    ok t_cmp("" . $self->get_config($s), "$srv_cfg",
+             'repeated per-srv get_config');
+
+    # $r->add_config merges a new per-dir config, which lookups must
+    # see instead of the one found before
+    $r->add_config(['MyOtherTest other'], -1);
+    my $new_cfg = $self->get_config($s, $r->per_dir_config);
+    ok t_cmp($new_cfg->{MyOtherTest}, 'other',
+             'MyOtherTest value after $r->add_config');
+    ok t_cmp("" . $self->get_config($s, $r->per_dir_config), "$new_cfg",
+             'repeated per-dir get_config after $r->add_config');
+
     Apache2::Const::OK;
 }
 
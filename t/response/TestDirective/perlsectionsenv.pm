@@ -0,0 +1,41 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestDirective::perlsectionsenv;
+
+# ${VAR} references in directives generated by <Perl> sections are
+# expanded the same way httpd expands them in the text config
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use Apache2::RequestRec ();
+
+use Apache2::Const -compile => 'OK';
+
+sub handler {
+    my $r = shift;
+
+    plan $r, tests => 1;
+
+    ok t_cmp($r->dir_config('PerlSectionsEnv'),
+             'perl_sections_env',
+             '${VAR} in a <Location> built by <Perl>');
+
+    Apache2::Const::OK;
+}
+
+1;
+__END__
+<NoAutoConfig>
+<Perl >
+$ENV{TestDirective__perlsectionsenv} = 'perl_sections_env';
+
+$Location{'/TestDirective__perlsectionsenv'} = {
+    SetHandler          => 'modperl',
+    PerlResponseHandler => 'TestDirective::perlsectionsenv',
+    PerlSetVar          => 'PerlSectionsEnv ${TestDirective__perlsectionsenv}',
+};
+</Perl>
+</NoAutoConfig>
@@ -0,0 +1,50 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestDirective::perltimelinesample;
+
+# PerlTimelineSample 1 records every request, the timeline of a
+# request is stored when it's finished, so the client fetches it with
+# a second request (over the same connection, so it gets the same
+# process)
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache2::RequestRec ();
+use Apache2::RequestIO ();
+use ModPerl::Util ();
+
+use Apache2::Const -compile => qw(OK DECLINED);
+
+sub fixup { Apache2::Const::DECLINED }
+
+sub handler {
+    my $r = shift;
+
+    $r->content_type('text/plain');
+
+    if (($r->args || '') eq 'dump') {
+        my $uri = $r->uri;
+        my ($record) = grep { /"uri":"\Q$uri\E"/ }
+            reverse @{ ModPerl::Util::timelines() };
+        $r->print($record || 'UNDEF');
+    }
+    else {
+        $r->print('ok');
+    }
+
+    return Apache2::Const::OK;
+}
+
+1;
+__END__
+<NoAutoConfig>
+<VirtualHost TestDirective::perltimelinesample>
+    KeepAlive On
+    PerlTimelineSample 1
+    <Location /TestDirective__perltimelinesample>
+        SetHandler modperl
+        PerlFixupHandler    TestDirective::perltimelinesample::fixup
+        PerlResponseHandler TestDirective::perltimelinesample
+    </Location>
+</VirtualHost>
+</NoAutoConfig>
@@ -17,7 +17,7 @@ use Apache2::Const -compile => 'OK';
 sub handler {
     my $r = shift;
 
-    plan $r, tests => 15;
+    plan $r, tests => 17;
 
     #Apache2::RequestRec::dir_config tests
 
@@ -120,6 +120,27 @@ sub handler {
                  "unset");
     }
 
+    # enough PerlSetVars to get the hashed lookup
+    {
+        my @keys = map { "TestModperl__request_rec_Many$_" } 1..10;
+        my @received = map { $r->dir_config(lc $_) } @keys;
+        my @expected = map { "Many$_" } 1..10;
+
+        ok t_cmp(\@received, \@expected,
+                 "hashed lookup of many keys");
+
+        $r->dir_config($keys[0] => 'Changed');
+        $r->dir_config($keys[1] => undef);
+        $r->dir_config->add(TestModperl__request_rec_ManyNew => 'New');
+
+        @received = map { $r->dir_config($_) }
+            @keys[0..2], 'TestModperl__request_rec_ManyNew';
+        @expected = ('Changed', undef, 'Many3', 'New');
+
+        ok t_cmp(\@received, \@expected,
+                 "lookup after runtime modifications");
+    }
+
 
     #Apache2::ServerUtil::dir_config tests
 
@@ -187,3 +208,14 @@ PerlAddVar TestModperl__request_rec_Key1 2_AddValue
 PerlAddVar TestModperl__request_rec_Key1 3_AddValue 4_AddValue
 
 PerlSetVar TestModperl__server_rec_Key_set_in_Base SubSecValue
+
+PerlSetVar TestModperl__request_rec_Many1 Many1
+PerlSetVar TestModperl__request_rec_Many2 Many2
+PerlSetVar TestModperl__request_rec_Many3 Many3
+PerlSetVar TestModperl__request_rec_Many4 Many4
+PerlSetVar TestModperl__request_rec_Many5 Many5
+PerlSetVar TestModperl__request_rec_Many6 Many6
+PerlSetVar TestModperl__request_rec_Many7 Many7
+PerlSetVar TestModperl__request_rec_Many8 Many8
+PerlSetVar TestModperl__request_rec_Many9 Many9
+PerlSetVar TestModperl__request_rec_Many10 Many10
@@ -0,0 +1,60 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestModperl::handlers_profile;
+
+# test PerlOptions +ProfileHandlers
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache2::RequestRec ();
+use Apache2::RequestIO ();
+use ModPerl::Util ();
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use Apache2::Const -compile => qw(OK DECLINED);
+
+sub fixup { Apache2::Const::DECLINED }
+
+sub handler {
+    my $r = shift;
+
+    plan $r, tests => 6;
+
+    my $profile = ModPerl::Util::handlers_profile();
+    my $entry = $profile->{__PACKAGE__ . '::fixup'};
+
+    ok $entry;
+
+    ok t_cmp($entry->{calls} >= 1, 1, "fixup handler calls counted");
+
+    ok t_cmp($entry->{errors}, 0, "no errors");
+
+    ok t_cmp($entry->{status}{Apache2::Const::DECLINED},
+             $entry->{calls},
+             "DECLINED status counted");
+
+    ok $entry->{wall_min} <= $entry->{wall_max};
+
+    ModPerl::Util::handlers_profile_reset();
+    $profile = ModPerl::Util::handlers_profile();
+
+    ok t_cmp(exists $profile->{__PACKAGE__ . '::fixup'}, '',
+             "profile reset");
+
+    Apache2::Const::OK;
+}
+
+1;
+__DATA__
+<NoAutoConfig>
+<VirtualHost TestModperl::handlers_profile>
+    PerlOptions +ProfileHandlers
+    <Location /TestModperl__handlers_profile>
+        SetHandler modperl
+        PerlFixupHandler     TestModperl::handlers_profile::fixup
+        PerlResponseHandler  TestModperl::handlers_profile
+    </Location>
+</VirtualHost>
+</NoAutoConfig>
@@ -0,0 +1,58 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestModperl::request_arena;
+
+# test PerlRequestArena (set in extra.conf.in): once the fixup phase is
+# over its $r wrapper is a spare, which the response phase gets back
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache2::RequestRec ();
+use Apache2::RequestUtil ();
+use ModPerl::Util ();
+use Scalar::Util ();
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use Apache2::Const -compile => qw(OK DECLINED);
+
+sub fixup {
+    my $r = shift;
+
+    $r->pnotes(fixup_wrapper => Scalar::Util::refaddr($r));
+    $r->pnotes(fixup_reused  =>
+               ModPerl::Util::request_arena_stats()->{reused});
+
+    Apache2::Const::DECLINED;
+}
+
+sub handler {
+    my $r = shift;
+
+    plan $r, tests => 6;
+
+    ok t_cmp(Scalar::Util::refaddr($r), $r->pnotes('fixup_wrapper'),
+             "the fixup wrapper is reused");
+
+    ok t_cmp(ref($r), 'Apache2::RequestRec', "reused wrapper class");
+
+    my $stats = ModPerl::Util::request_arena_stats();
+
+    ok t_cmp($stats->{size}, 16, "arena size");
+
+    ok t_cmp($stats->{reused} >= 1, 1, "reused objects counted");
+
+    # at least the args AV and $r of the response phase
+    ok t_cmp($stats->{reused} - $r->pnotes('fixup_reused') >= 2, 1,
+             "response phase args came from the arena");
+
+    ok exists $stats->{sv_growth_per_request};
+
+    Apache2::Const::OK;
+}
+
+1;
+__DATA__
+PerlFixupHandler TestModperl::request_arena::fixup
+SetHandler modperl
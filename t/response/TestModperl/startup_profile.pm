@@ -0,0 +1,55 @@
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+package TestModperl::startup_profile;
+
+# test PerlStartupProfile and PerlWarmupHandler (see extra.conf.in)
+
+use strict;
+use warnings FATAL => 'all';
+
+use Apache2::ServerRec ();
+use APR::Pool ();
+
+use Apache::Test;
+use Apache::TestUtil;
+
+use File::Spec::Functions qw(catfile);
+
+use Apache2::Const -compile => 'OK';
+
+our $warmed_up = 0;
+
+sub warmup {
+    my ($pool, $s) = @_;
+
+    $warmed_up++ if ref $pool eq 'APR::Pool' &&
+        ref $s eq 'Apache2::ServerRec';
+
+    Apache2::Const::OK;
+}
+
+sub handler {
+    my $r = shift;
+
+    plan $r, tests => 4;
+
+    ok t_cmp($warmed_up >= 1, 1, "PerlWarmupHandler ran in the parent");
+
+    my $file = catfile Apache::Test::vars('serverroot'),
+        qw(logs startup_profile.txt);
+    open my $fh, '<', $file or die "can't open $file: $!";
+    my @lines = <$fh>;
+    close $fh;
+
+    ok t_cmp($lines[0], qr/^# mod_perl startup profile, pid \d+/,
+             "report header");
+
+    ok t_cmp(scalar(grep /\bmodule\s+TestExit::FromPerlModule$/, @lines),
+             1, "PerlModule timed");
+
+    ok t_cmp(scalar(grep /\bwarmup\s+${\__PACKAGE__}::warmup$/, @lines),
+             1, "PerlWarmupHandler timed");
+
+    Apache2::Const::OK;
+}
+
+1;
@@ -16,11 +16,41 @@ use Apache2::Const -compile => 'OK';
 sub handler {
     my $r = shift;
 
-    plan $r, tests => 1;
+    plan $r, tests => 6;
 
     ok t_cmp ModPerl::Util::current_perl_id(), qr/0x\w+/,
         "perl interpreter id";
 
+    # unload a package together with its sub-packages
+    {
+        eval q{
+            package TestModperl::util::Tree;
+            sub foo { 1 }
+            package TestModperl::util::Tree::Sub;
+            our $bar = 1;
+            package TestModperl::util::Tree::Sub::Deeper;
+            sub baz { 1 }
+            1;
+        } or die $@;
+        $INC{'TestModperl/util/Tree/Sub.pm'} = __FILE__;
+
+        my $before = ModPerl::Util::unload_package_stats();
+
+        ModPerl::Util::unload_package_tree('TestModperl::util::Tree');
+
+        # look the symbols up at run time: the globs bound when this
+        # file was compiled outlive their removal from the stash
+        no strict 'refs';
+        ok !defined &{"TestModperl::util::Tree::foo"};
+        ok !defined ${"TestModperl::util::Tree::Sub::bar"};
+        ok !TestModperl::util::Tree::Sub::Deeper->can('baz');
+        ok !exists $INC{'TestModperl/util/Tree/Sub.pm'};
+
+        my $after = ModPerl::Util::unload_package_stats();
+        ok t_cmp $after->{packages} - $before->{packages}, 3,
+            "unloaded packages are counted";
+    }
+
     Apache2::Const::OK;
 }
 
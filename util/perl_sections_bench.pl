@@ -0,0 +1,80 @@
+#!/usr/bin/perl -w
+# please insert nothing before this line: -*- mode: cperl; cperl-indent-level: 4; cperl-continued-statement-offset: 4; indent-tabs-mode: nil -*-
+
+# times the configuration of a server whose <Perl> section generates
+# lots of <Location> blocks, once with the sections handed to httpd as
+# directive nodes and once as config text
+# ($Apache2::PerlSections::TextConfig = 1)
+#
+# perl_sections_bench.pl --httpd /path/to/httpd \
+#     [--module /path/to/mod_perl.so] [--include /path/to/extra.conf] \
+#     [--count 10000] [--runs 5]
+#
+# --include is for whatever else the httpd needs loaded to start
+# (mpm, authz modules, ...), it's included before the <Perl> section
+
+use strict;
+
+use Getopt::Long ();
+use File::Temp ();
+use Time::HiRes ();
+
+my %opts = (count => 10_000, runs => 5);
+
+Getopt::Long::GetOptions(\%opts, 'httpd=s', 'module=s', 'include=s',
+                         'count=i', 'runs=i')
+    or die "usage: $0 --httpd path [--module path] [--include path] " .
+        "[--count n] [--runs n]\n";
+
+die "--httpd is required\n" unless $opts{httpd};
+
+my $dir = File::Temp::tempdir(CLEANUP => 1);
+
+printf "%d <Location> blocks, best of %d runs\n",
+    $opts{count}, $opts{runs};
+
+for my $mode (qw(nodes text)) {
+    my $conf = write_conf($dir, $mode eq 'text' ? 1 : 0);
+    my $best;
+
+    for (1 .. $opts{runs}) {
+        my $start = [Time::HiRes::gettimeofday()];
+        my $out = `$opts{httpd} -t -f $conf 2>&1`;
+        die "$opts{httpd} -t failed:\n$out" if $?;
+        my $took = Time::HiRes::tv_interval($start);
+        $best = $took if !defined $best or $took < $best;
+    }
+
+    printf "%-6s %8.3f secs\n", $mode, $best;
+}
+
+sub write_conf {
+    my ($dir, $text) = @_;
+
+    my $file = "$dir/httpd.conf";
+    open my $fh, '>', $file or die "open $file: $!";
+
+    print $fh "ServerRoot $dir\n";
+    print $fh "PidFile $dir/httpd.pid\n";
+    print $fh "ErrorLog $dir/error_log\n";
+    print $fh "Listen 127.0.0.1:8529\n";
+    print $fh "LoadModule perl_module $opts{module}\n" if $opts{module};
+    print $fh "Include $opts{include}\n" if $opts{include};
+
+    print $fh <<"CONF";
+<Perl>
+\$Apache2::PerlSections::TextConfig = $text;
+for my \$i (1 .. $opts{count}) {
+    \$Location{"/bench/\$i"} = {
+        SetHandler          => 'modperl',
+        PerlResponseHandler => 'Bench::handler',
+        PerlSetVar          => [Bench => \$i],
+    };
+}
+</Perl>
+CONF
+
+    close $fh;
+
+    return $file;
+}
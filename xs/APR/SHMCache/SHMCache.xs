@@ -0,0 +1,269 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+#include "modperl_xs_util.h"
+#include "modperl_apr_shmcache.h"
+
+typedef struct {
+#ifdef USE_ITHREADS
+    PerlInterpreter *perl;
+#endif
+    SV *sv;
+} mpxs_shmcache_copy_t;
+
+/* the value goes straight from the segment into the SV's buffer */
+static void mpxs_shmcache_copy(void *data, const char *val, apr_size_t vlen)
+{
+    mpxs_shmcache_copy_t *copy = (mpxs_shmcache_copy_t *)data;
+#ifdef USE_ITHREADS
+    dTHXa(copy->perl);
+#endif
+    sv_setpvn(copy->sv, val, vlen);
+}
+
+static modperl_apr_shmcache_t *mpxs_sv2_shmcache(pTHX_ SV *sv)
+{
+    if (!(sv_isobject(sv) && sv_derived_from(sv, "APR::SHMCache"))) {
+        Perl_croak(aTHX_ "argument is not a blessed reference "
+                   "(expecting an APR::SHMCache derived object)");
+    }
+
+    return INT2PTR(modperl_apr_shmcache_t *, SvIV((SV *)SvRV(sv)));
+}
+
+/* the segment holds bytes, so characters above 0xFF can't go in.
+ * the caller's SV is left alone, a copy of it is downgraded */
+static const char *mpxs_shmcache_bytes(pTHX_ SV *sv, STRLEN *len,
+                                       const char *func)
+{
+    if (SvUTF8(sv)) {
+        sv = sv_mortalcopy(sv);
+        if (!sv_utf8_downgrade(sv, TRUE)) {
+            Perl_croak(aTHX_ "APR::SHMCache::%s: wide character, "
+                       "encode the string first", func);
+        }
+    }
+
+    return SvPV(sv, *len);
+}
+
+static SV *mpxs_shmcache_get(pTHX_ SV *obj, SV *key, apr_uint64_t *cas)
+{
+    modperl_apr_shmcache_t *cache = mpxs_sv2_shmcache(aTHX_ obj);
+    mpxs_shmcache_copy_t copy;
+    STRLEN klen;
+    const char *k = mpxs_shmcache_bytes(aTHX_ key, &klen, "get");
+    apr_status_t rv;
+
+#ifdef USE_ITHREADS
+    copy.perl = aTHX;
+#endif
+    copy.sv = newSV(0);
+
+    rv = modperl_apr_shmcache_get(cache, k, klen, mpxs_shmcache_copy,
+                                  (void *)&copy, cas);
+
+    if (rv != APR_SUCCESS) {
+        SvREFCNT_dec(copy.sv);
+        return (SV *)NULL;
+    }
+
+    return copy.sv;
+}
+
+static int mpxs_shmcache_set(pTHX_ SV *obj, SV *key, SV *val,
+                             apr_uint32_t ttl, apr_uint64_t cas)
+{
+    modperl_apr_shmcache_t *cache = mpxs_sv2_shmcache(aTHX_ obj);
+    STRLEN klen, vlen;
+    const char *k = mpxs_shmcache_bytes(aTHX_ key, &klen, "set");
+    const char *v = mpxs_shmcache_bytes(aTHX_ val, &vlen, "set");
+
+    return modperl_apr_shmcache_set(cache, k, klen, v, vlen,
+                                    ttl, cas) == APR_SUCCESS;
+}
+
+MODULE = APR::SHMCache    PACKAGE = APR::SHMCache
+
+PROTOTYPES: disabled
+
+SV *
+new(classname, p_sv, ...)
+    SV *classname
+    SV *p_sv
+
+    PREINIT:
+    apr_pool_t *p;
+    apr_size_t size = 0, page_size = 65536;
+    int stripes = 16;
+    const char *file = NULL;
+    modperl_apr_shmcache_t *cache;
+    apr_status_t rv;
+    I32 i;
+
+    CODE:
+    /* XXX: can't reuse a wrapper mp_xs_sv2_APR__Pool */
+    if (SvROK(p_sv) && (SvTYPE(SvRV(p_sv)) == SVt_PVMG)) {
+        p = INT2PTR(apr_pool_t *, SvIV((SV*)SvRV(p_sv)));
+    }
+    else {
+        Perl_croak(aTHX_ "argument is not a blessed reference "
+                   "(expecting an APR::Pool derived object)");
+    }
+
+    if ((items - 2) % 2) {
+        Perl_croak(aTHX_ "usage: APR::SHMCache->new($pool, size => $bytes, "
+                   "[stripes => $n, page_size => $bytes, file => $path])");
+    }
+
+    for (i = 2; i < items; i += 2) {
+        const char *opt = SvPV_nolen(ST(i));
+        SV *val = ST(i + 1);
+
+        if (strEQ(opt, "size")) {
+            size = (apr_size_t)SvUV(val);
+        }
+        else if (strEQ(opt, "stripes")) {
+            stripes = (int)SvIV(val);
+        }
+        else if (strEQ(opt, "page_size")) {
+            page_size = (apr_size_t)SvUV(val);
+        }
+        else if (strEQ(opt, "file")) {
+            file = SvOK(val) ? SvPV_nolen(val) : NULL;
+        }
+        else {
+            Perl_croak(aTHX_ "APR::SHMCache->new: unknown option '%s'", opt);
+        }
+    }
+
+    if (!size) {
+        Perl_croak(aTHX_ "APR::SHMCache->new: the size option is required");
+    }
+
+    rv = modperl_apr_shmcache_create(&cache, size, stripes, page_size,
+                                     file, p);
+    if (rv != APR_SUCCESS) {
+        modperl_croak(aTHX_ rv, "APR::SHMCache::new");
+    }
+
+    RETVAL = sv_setref_pv(newSV(0), SvPV_nolen(classname), (void *)cache);
+    mpxs_add_pool_magic(RETVAL, p_sv);
+
+    OUTPUT:
+    RETVAL
+
+SV *
+get(obj, key)
+    SV *obj
+    SV *key
+
+    CODE:
+    RETVAL = mpxs_shmcache_get(aTHX_ obj, key, NULL);
+    if (!RETVAL) {
+        XSRETURN_UNDEF;
+    }
+
+    OUTPUT:
+    RETVAL
+
+void
+gets(obj, key)
+    SV *obj
+    SV *key
+
+    PREINIT:
+    apr_uint64_t cas;
+    SV *val;
+
+    PPCODE:
+    if ((val = mpxs_shmcache_get(aTHX_ obj, key, &cas))) {
+        EXTEND(SP, 2);
+        PUSHs(sv_2mortal(val));
+        /* NV holds the tokens exactly up to 2**53 */
+        PUSHs(sv_2mortal(newSVnv((NV)cas)));
+    }
+
+int
+set(obj, key, val, ttl=0)
+    SV *obj
+    SV *key
+    SV *val
+    UV ttl
+
+    CODE:
+    RETVAL = mpxs_shmcache_set(aTHX_ obj, key, val, (apr_uint32_t)ttl, 0);
+
+    OUTPUT:
+    RETVAL
+
+int
+cas(obj, key, val, cas, ttl=0)
+    SV *obj
+    SV *key
+    SV *val
+    NV cas
+    UV ttl
+
+    CODE:
+    if (cas < 1) {
+        Perl_croak(aTHX_ "APR::SHMCache::cas: invalid cas token");
+    }
+    RETVAL = mpxs_shmcache_set(aTHX_ obj, key, val, (apr_uint32_t)ttl,
+                               (apr_uint64_t)cas);
+
+    OUTPUT:
+    RETVAL
+
+int
+delete(obj, key)
+    SV *obj
+    SV *key
+
+    PREINIT:
+    STRLEN klen;
+    const char *k;
+
+    CODE:
+    k = mpxs_shmcache_bytes(aTHX_ key, &klen, "delete");
+    RETVAL = modperl_apr_shmcache_delete(mpxs_sv2_shmcache(aTHX_ obj),
+                                         k, klen) == APR_SUCCESS;
+
+    OUTPUT:
+    RETVAL
+
+SV *
+stats(obj)
+    SV *obj
+
+    PREINIT:
+    modperl_apr_shmcache_stats_t stats;
+    HV *hv;
+
+    CODE:
+    modperl_apr_shmcache_stats(mpxs_sv2_shmcache(aTHX_ obj), &stats);
+    hv = newHV();
+    (void)hv_store(hv, "hits",      4, newSVnv((NV)stats.hits), 0);
+    (void)hv_store(hv, "misses",    6, newSVnv((NV)stats.misses), 0);
+    (void)hv_store(hv, "sets",      4, newSVnv((NV)stats.sets), 0);
+    (void)hv_store(hv, "evictions", 9, newSVnv((NV)stats.evictions), 0);
+    (void)hv_store(hv, "expired",   7, newSVnv((NV)stats.expired), 0);
+    (void)hv_store(hv, "items",     5, newSVuv(stats.items), 0);
+    RETVAL = newRV_noinc((SV *)hv);
+
+    OUTPUT:
+    RETVAL
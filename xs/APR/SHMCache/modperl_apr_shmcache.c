@@ -0,0 +1,662 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mod_perl.h"
+#include "modperl_apr_shmcache.h"
+
+#include "apr_proc_mutex.h"
+#include "apr_time.h"
+
+/*
+ * the segment starts with a header and the stripe descriptors,
+ * followed by one region per stripe, holding the stripe's hash
+ * buckets and its pages.  everything in the segment refers to
+ * everything else by offset from the segment start.
+ *
+ * each page is carved into equally sized chunks of one size class
+ * (64 bytes << class) when first needed.  entries live in the
+ * smallest chunk that fits them, freed chunks go to the free list of
+ * their class.  when a class has no free chunk and no page is left,
+ * a clock hand sweeping the class' chunks evicts the first entry not
+ * read since the hand last passed it; a class which has no page at
+ * all takes one from the class with most pages.
+ *
+ * each stripe has its own APR proc mutex, which the system releases
+ * when its holder dies.  the holder marks the stripe busy while it
+ * holds the mutex, so the next one to take it finds the mark left by a
+ * holder which died in the middle of an update, and wipes the stripe.
+ */
+
+#define MP_SHMCACHE_MIN_CHUNK 64
+#define MP_SHMCACHE_CLASSES   32
+
+#define MP_SHMCACHE_INUSE     0x1
+#define MP_SHMCACHE_REF       0x2
+
+/* the mutexes must exclude the threads of a process from each other
+ * too, which fcntl() and flock() locks don't do */
+#if APR_HAS_SYSVSEM_SERIALIZE
+#define MP_SHMCACHE_LOCK_MECH APR_LOCK_SYSVSEM
+#elif APR_HAS_PROC_PTHREAD_SERIALIZE
+#define MP_SHMCACHE_LOCK_MECH APR_LOCK_PROC_PTHREAD
+#else
+#define MP_SHMCACHE_LOCK_MECH APR_LOCK_DEFAULT
+#endif
+
+#define MP_SHMCACHE_ALIGN(n)  (((n) + 7) & ~(apr_size_t)7)
+
+typedef struct {
+    volatile apr_uint32_t busy;
+    apr_uint32_t buckets;
+    apr_uint32_t nbuckets;
+    apr_uint32_t pages;
+    apr_uint32_t npages;
+    apr_uint32_t pages_used;
+    apr_uint32_t free[MP_SHMCACHE_CLASSES];
+    apr_uint32_t class_pages[MP_SHMCACHE_CLASSES];
+    apr_uint32_t class_npages[MP_SHMCACHE_CLASSES];
+    apr_uint32_t hand[MP_SHMCACHE_CLASSES];
+    apr_uint64_t version;
+    modperl_apr_shmcache_stats_t stats;
+} mp_shmcache_stripe_t;
+
+typedef struct {
+    apr_uint32_t nstripes;
+    apr_uint32_t page_size;
+} mp_shmcache_header_t;
+
+typedef struct {
+    apr_uint32_t next;   /* next page of the same class */
+    apr_uint32_t klass;
+} mp_shmcache_page_t;
+
+typedef struct {
+    apr_uint32_t next;   /* hash chain, or free list */
+    apr_uint32_t hash;
+    apr_uint64_t cas;
+    apr_time_t expires;
+    apr_uint32_t klen;
+    apr_uint32_t vlen;
+    apr_uint16_t klass;
+    apr_uint16_t flags;
+} mp_shmcache_item_t;
+
+struct modperl_apr_shmcache_t {
+    apr_shm_t *shm;
+    char *base;
+    mp_shmcache_header_t *header;
+    mp_shmcache_stripe_t *stripes;
+    apr_proc_mutex_t **mutex;
+};
+
+#define MP_SHMCACHE_AT(cache, off) ((void *)((cache)->base + (off)))
+#define MP_SHMCACHE_OFF(cache, ptr) \
+    ((apr_uint32_t)((char *)(ptr) - (cache)->base))
+
+#define MP_SHMCACHE_PAGE_HDR MP_SHMCACHE_ALIGN(sizeof(mp_shmcache_page_t))
+
+#define MP_SHMCACHE_CHUNK(klass) \
+    ((apr_uint32_t)MP_SHMCACHE_MIN_CHUNK << (klass))
+
+#define MP_SHMCACHE_CHUNKS(cache, klass) \
+    (((cache)->header->page_size - MP_SHMCACHE_PAGE_HDR) / \
+     MP_SHMCACHE_CHUNK(klass))
+
+#define MP_SHMCACHE_KEY(item) ((char *)((item) + 1))
+#define MP_SHMCACHE_VAL(item) (MP_SHMCACHE_KEY(item) + (item)->klen)
+
+/* FNV-1a */
+static apr_uint32_t mp_shmcache_hash(const char *key, apr_size_t klen)
+{
+    apr_uint32_t hash = 2166136261U;
+    const unsigned char *p = (const unsigned char *)key;
+
+    while (klen--) {
+        hash ^= *p++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static void mp_shmcache_stripe_reset(mp_shmcache_stripe_t *st,
+                                     modperl_apr_shmcache_t *cache)
+{
+    memset(MP_SHMCACHE_AT(cache, st->buckets), 0,
+           st->nbuckets * sizeof(apr_uint32_t));
+
+    st->pages_used = 0;
+    memset(st->free, 0, sizeof(st->free));
+    memset(st->class_pages, 0, sizeof(st->class_pages));
+    memset(st->class_npages, 0, sizeof(st->class_npages));
+    memset(st->hand, 0, sizeof(st->hand));
+    st->stats.items = 0;
+}
+
+static void mp_shmcache_lock(modperl_apr_shmcache_t *cache,
+                             mp_shmcache_stripe_t *st)
+{
+    (void)apr_proc_mutex_lock(cache->mutex[st - cache->stripes]);
+
+    if (st->busy) {
+        /* the holder died in the middle of an update */
+        mp_shmcache_stripe_reset(st, cache);
+    }
+    st->busy = 1;
+}
+
+static void mp_shmcache_unlock(modperl_apr_shmcache_t *cache,
+                               mp_shmcache_stripe_t *st)
+{
+    st->busy = 0;
+    (void)apr_proc_mutex_unlock(cache->mutex[st - cache->stripes]);
+}
+
+static mp_shmcache_stripe_t *mp_shmcache_stripe(modperl_apr_shmcache_t *cache,
+                                                apr_uint32_t hash)
+{
+    return &cache->stripes[hash % cache->header->nstripes];
+}
+
+static apr_uint32_t *mp_shmcache_bucket(modperl_apr_shmcache_t *cache,
+                                        mp_shmcache_stripe_t *st,
+                                        apr_uint32_t hash)
+{
+    apr_uint32_t *buckets =
+        (apr_uint32_t *)MP_SHMCACHE_AT(cache, st->buckets);
+    return &buckets[(hash / cache->header->nstripes) % st->nbuckets];
+}
+
+/* returns the slot pointing to the entry, so it can be unlinked */
+static apr_uint32_t *mp_shmcache_find(modperl_apr_shmcache_t *cache,
+                                      mp_shmcache_stripe_t *st,
+                                      apr_uint32_t hash,
+                                      const char *key, apr_size_t klen)
+{
+    apr_uint32_t *slot = mp_shmcache_bucket(cache, st, hash);
+
+    while (*slot) {
+        mp_shmcache_item_t *item =
+            (mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, *slot);
+        if (item->hash == hash && item->klen == klen &&
+            memcmp(MP_SHMCACHE_KEY(item), key, klen) == 0) {
+            return slot;
+        }
+        slot = &item->next;
+    }
+
+    return NULL;
+}
+
+static void mp_shmcache_unlink(modperl_apr_shmcache_t *cache,
+                               mp_shmcache_stripe_t *st,
+                               mp_shmcache_item_t *item)
+{
+    apr_uint32_t off = MP_SHMCACHE_OFF(cache, item);
+    apr_uint32_t *slot = mp_shmcache_bucket(cache, st, item->hash);
+
+    while (*slot && *slot != off) {
+        slot = &((mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, *slot))->next;
+    }
+    if (*slot) {
+        *slot = item->next;
+    }
+
+    item->flags = 0;
+    st->stats.items--;
+}
+
+static void mp_shmcache_free(modperl_apr_shmcache_t *cache,
+                             mp_shmcache_stripe_t *st,
+                             mp_shmcache_item_t *item)
+{
+    mp_shmcache_unlink(cache, st, item);
+    item->next = st->free[item->klass];
+    st->free[item->klass] = MP_SHMCACHE_OFF(cache, item);
+}
+
+static int mp_shmcache_expired(mp_shmcache_item_t *item, apr_time_t now)
+{
+    return item->expires && item->expires <= now;
+}
+
+static void mp_shmcache_page_init(modperl_apr_shmcache_t *cache,
+                                  mp_shmcache_stripe_t *st,
+                                  apr_uint32_t off, int klass)
+{
+    mp_shmcache_page_t *page =
+        (mp_shmcache_page_t *)MP_SHMCACHE_AT(cache, off);
+    apr_uint32_t i, n = MP_SHMCACHE_CHUNKS(cache, klass);
+
+    page->klass = klass;
+    page->next = st->class_pages[klass];
+    st->class_pages[klass] = off;
+    st->class_npages[klass]++;
+
+    /* in reverse, so the free list hands the chunks out in order */
+    for (i = n; i-- > 0;) {
+        apr_uint32_t coff = off + MP_SHMCACHE_PAGE_HDR +
+            i * MP_SHMCACHE_CHUNK(klass);
+        mp_shmcache_item_t *item =
+            (mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, coff);
+        item->flags = 0;
+        item->klass = klass;
+        item->next = st->free[klass];
+        st->free[klass] = coff;
+    }
+}
+
+/* takes the first page of the class with most pages for klass */
+static int mp_shmcache_page_steal(modperl_apr_shmcache_t *cache,
+                                  mp_shmcache_stripe_t *st, int klass)
+{
+    apr_uint32_t off, end, i, n, *slot;
+    int victim = -1, k;
+
+    for (k = 0; k < MP_SHMCACHE_CLASSES; k++) {
+        if (k != klass && st->class_npages[k] &&
+            (victim < 0 ||
+             st->class_npages[k] > st->class_npages[victim])) {
+            victim = k;
+        }
+    }
+
+    if (victim < 0) {
+        return FALSE;
+    }
+
+    off = st->class_pages[victim];
+    end = off + cache->header->page_size;
+    n = MP_SHMCACHE_CHUNKS(cache, victim);
+
+    for (i = 0; i < n; i++) {
+        mp_shmcache_item_t *item = (mp_shmcache_item_t *)
+            MP_SHMCACHE_AT(cache, off + MP_SHMCACHE_PAGE_HDR +
+                           i * MP_SHMCACHE_CHUNK(victim));
+        if (item->flags & MP_SHMCACHE_INUSE) {
+            mp_shmcache_unlink(cache, st, item);
+            st->stats.evictions++;
+        }
+    }
+
+    /* drop the page's chunks from its class' free list */
+    slot = &st->free[victim];
+    while (*slot) {
+        if (*slot >= off && *slot < end) {
+            *slot = ((mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, *slot))->next;
+        }
+        else {
+            slot = &((mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, *slot))->next;
+        }
+    }
+
+    st->class_pages[victim] =
+        ((mp_shmcache_page_t *)MP_SHMCACHE_AT(cache, off))->next;
+    st->class_npages[victim]--;
+    if (st->hand[victim] >= off && st->hand[victim] < end) {
+        st->hand[victim] = 0;
+    }
+
+    mp_shmcache_page_init(cache, st, off, klass);
+
+    return TRUE;
+}
+
+/* moves the clock hand of klass to the next chunk */
+static apr_uint32_t mp_shmcache_hand_next(modperl_apr_shmcache_t *cache,
+                                          mp_shmcache_stripe_t *st,
+                                          int klass, apr_uint32_t hand)
+{
+    apr_uint32_t csize = MP_SHMCACHE_CHUNK(klass);
+    apr_uint32_t page, last;
+
+    if (hand) {
+        page = hand - (hand - st->pages) % cache->header->page_size;
+        last = page + MP_SHMCACHE_PAGE_HDR +
+            (MP_SHMCACHE_CHUNKS(cache, klass) - 1) * csize;
+        if (hand < last) {
+            return hand + csize;
+        }
+        page = ((mp_shmcache_page_t *)MP_SHMCACHE_AT(cache, page))->next;
+    }
+    else {
+        page = 0;
+    }
+
+    if (!page) {
+        page = st->class_pages[klass];
+    }
+
+    return page + MP_SHMCACHE_PAGE_HDR;
+}
+
+static mp_shmcache_item_t *mp_shmcache_alloc(modperl_apr_shmcache_t *cache,
+                                             mp_shmcache_stripe_t *st,
+                                             int klass, apr_time_t now)
+{
+    mp_shmcache_item_t *item;
+    apr_uint32_t i, sweep;
+
+    if (!st->free[klass]) {
+        if (st->pages_used < st->npages) {
+            mp_shmcache_page_init(cache, st,
+                                  st->pages + st->pages_used++ *
+                                  cache->header->page_size, klass);
+        }
+        else if (!st->class_npages[klass]) {
+            if (!mp_shmcache_page_steal(cache, st, klass)) {
+                return NULL;
+            }
+        }
+    }
+
+    if (st->free[klass]) {
+        item = (mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, st->free[klass]);
+        st->free[klass] = item->next;
+        return item;
+    }
+
+    /* two rounds: the first one may only clear the REF bits */
+    sweep = 2 * st->class_npages[klass] * MP_SHMCACHE_CHUNKS(cache, klass);
+
+    for (i = 0; i < sweep; i++) {
+        st->hand[klass] = mp_shmcache_hand_next(cache, st, klass,
+                                                st->hand[klass]);
+        item = (mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, st->hand[klass]);
+
+        if (!(item->flags & MP_SHMCACHE_INUSE)) {
+            continue; /* on the free list */
+        }
+
+        if ((item->flags & MP_SHMCACHE_REF) &&
+            !mp_shmcache_expired(item, now)) {
+            item->flags &= ~MP_SHMCACHE_REF;
+            continue;
+        }
+
+        if (mp_shmcache_expired(item, now)) {
+            st->stats.expired++;
+        }
+        else {
+            st->stats.evictions++;
+        }
+        mp_shmcache_unlink(cache, st, item);
+
+        return item;
+    }
+
+    return NULL;
+}
+
+apr_status_t modperl_apr_shmcache_create(modperl_apr_shmcache_t **cachep,
+                                         apr_size_t size,
+                                         int stripes,
+                                         apr_size_t page_size,
+                                         const char *file,
+                                         apr_pool_t *p)
+{
+    modperl_apr_shmcache_t *cache;
+    apr_size_t hsize, region;
+    apr_status_t rv;
+    int i;
+
+    /* offsets in the segment are 32 bit */
+    if (stripes < 1 || page_size < 1024 || page_size > (1 << 30) ||
+        (page_size & (page_size - 1)) || size > 0xffffffffUL) {
+        return APR_EINVAL;
+    }
+
+    hsize = MP_SHMCACHE_ALIGN(sizeof(mp_shmcache_header_t) +
+                              stripes * sizeof(mp_shmcache_stripe_t));
+
+    if (size <= hsize) {
+        return APR_EINVAL;
+    }
+
+    region = ((size - hsize) / stripes) & ~(apr_size_t)7;
+
+    cache = (modperl_apr_shmcache_t *)apr_pcalloc(p, sizeof(*cache));
+
+    if (file) {
+        (void)apr_shm_remove(file, p);
+    }
+
+    if ((rv = apr_shm_create(&cache->shm, size, file, p)) != APR_SUCCESS) {
+        return rv;
+    }
+
+    cache->base = (char *)apr_shm_baseaddr_get(cache->shm);
+    cache->header = (mp_shmcache_header_t *)cache->base;
+    cache->stripes = (mp_shmcache_stripe_t *)(cache->header + 1);
+
+    memset(cache->base, 0, hsize);
+    cache->header->nstripes  = stripes;
+    cache->header->page_size = page_size;
+
+    for (i = 0; i < stripes; i++) {
+        mp_shmcache_stripe_t *st = &cache->stripes[i];
+        apr_size_t start = hsize + i * region;
+
+        /* a bucket per 256 bytes of entries */
+        st->nbuckets = region / 256 > 0 ? region / 256 : 1;
+        st->buckets = start;
+        st->pages = start +
+            MP_SHMCACHE_ALIGN(st->nbuckets * sizeof(apr_uint32_t));
+        st->npages = st->pages < start + region ?
+            (start + region - st->pages) / page_size : 0;
+
+        if (!st->npages) {
+            apr_shm_destroy(cache->shm);
+            return APR_ENOSPC;
+        }
+
+        mp_shmcache_stripe_reset(st, cache);
+    }
+
+    cache->mutex = (apr_proc_mutex_t **)
+        apr_palloc(p, stripes * sizeof(*cache->mutex));
+
+    for (i = 0; i < stripes; i++) {
+        rv = apr_proc_mutex_create(&cache->mutex[i], NULL,
+                                   MP_SHMCACHE_LOCK_MECH, p);
+        if (rv != APR_SUCCESS) {
+            apr_shm_destroy(cache->shm);
+            return rv;
+        }
+    }
+
+    *cachep = cache;
+
+    return APR_SUCCESS;
+}
+
+static int mp_shmcache_klass(modperl_apr_shmcache_t *cache, apr_size_t size)
+{
+    int klass;
+
+    for (klass = 0; klass < MP_SHMCACHE_CLASSES; klass++) {
+        if (MP_SHMCACHE_CHUNK(klass) + MP_SHMCACHE_PAGE_HDR >
+            cache->header->page_size) {
+            break;
+        }
+        if (MP_SHMCACHE_CHUNK(klass) >= size) {
+            return klass;
+        }
+    }
+
+    return -1;
+}
+
+apr_status_t modperl_apr_shmcache_get(modperl_apr_shmcache_t *cache,
+                                      const char *key, apr_size_t klen,
+                                      modperl_apr_shmcache_copy_t copy,
+                                      void *data, apr_uint64_t *cas)
+{
+    apr_uint32_t hash = mp_shmcache_hash(key, klen);
+    mp_shmcache_stripe_t *st = mp_shmcache_stripe(cache, hash);
+    apr_time_t now = apr_time_now();
+    mp_shmcache_item_t *item = NULL;
+    apr_uint32_t *slot;
+
+    mp_shmcache_lock(cache, st);
+
+    if ((slot = mp_shmcache_find(cache, st, hash, key, klen))) {
+        item = (mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, *slot);
+        if (mp_shmcache_expired(item, now)) {
+            mp_shmcache_free(cache, st, item);
+            st->stats.expired++;
+            item = NULL;
+        }
+    }
+
+    if (!item) {
+        st->stats.misses++;
+        mp_shmcache_unlock(cache, st);
+        return APR_NOTFOUND;
+    }
+
+    item->flags |= MP_SHMCACHE_REF;
+    st->stats.hits++;
+
+    if (cas) {
+        *cas = item->cas;
+    }
+
+    copy(data, MP_SHMCACHE_VAL(item), item->vlen);
+
+    mp_shmcache_unlock(cache, st);
+
+    return APR_SUCCESS;
+}
+
+apr_status_t modperl_apr_shmcache_set(modperl_apr_shmcache_t *cache,
+                                      const char *key, apr_size_t klen,
+                                      const char *val, apr_size_t vlen,
+                                      apr_uint32_t ttl, apr_uint64_t cas)
+{
+    apr_uint32_t hash = mp_shmcache_hash(key, klen);
+    mp_shmcache_stripe_t *st = mp_shmcache_stripe(cache, hash);
+    apr_time_t now = apr_time_now();
+    mp_shmcache_item_t *item;
+    apr_uint32_t *slot, *bucket;
+    int klass = mp_shmcache_klass(cache, sizeof(*item) + klen + vlen);
+
+    if (klass < 0) {
+        return APR_ENOSPC;
+    }
+
+    mp_shmcache_lock(cache, st);
+
+    if ((slot = mp_shmcache_find(cache, st, hash, key, klen))) {
+        item = (mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, *slot);
+        if (mp_shmcache_expired(item, now)) {
+            mp_shmcache_free(cache, st, item);
+            st->stats.expired++;
+            slot = NULL;
+        }
+        else if (cas && item->cas != cas) {
+            mp_shmcache_unlock(cache, st);
+            return APR_EEXIST;
+        }
+        else {
+            /* replaced by a new chunk, the size may have changed */
+            mp_shmcache_free(cache, st, item);
+        }
+    }
+
+    if (!slot && cas) {
+        mp_shmcache_unlock(cache, st);
+        return APR_NOTFOUND;
+    }
+
+    if (!(item = mp_shmcache_alloc(cache, st, klass, now))) {
+        mp_shmcache_unlock(cache, st);
+        return APR_ENOSPC;
+    }
+
+    item->hash    = hash;
+    item->cas     = ++st->version;
+    item->expires = ttl ? now + apr_time_from_sec(ttl) : 0;
+    item->klen    = klen;
+    item->vlen    = vlen;
+    item->klass   = klass;
+    item->flags   = MP_SHMCACHE_INUSE;
+    memcpy(MP_SHMCACHE_KEY(item), key, klen);
+    memcpy(MP_SHMCACHE_VAL(item), val, vlen);
+
+    bucket = mp_shmcache_bucket(cache, st, hash);
+    item->next = *bucket;
+    *bucket = MP_SHMCACHE_OFF(cache, item);
+
+    st->stats.items++;
+    st->stats.sets++;
+
+    mp_shmcache_unlock(cache, st);
+
+    return APR_SUCCESS;
+}
+
+apr_status_t modperl_apr_shmcache_delete(modperl_apr_shmcache_t *cache,
+                                         const char *key, apr_size_t klen)
+{
+    apr_uint32_t hash = mp_shmcache_hash(key, klen);
+    mp_shmcache_stripe_t *st = mp_shmcache_stripe(cache, hash);
+    apr_uint32_t *slot;
+    apr_status_t rv = APR_NOTFOUND;
+
+    mp_shmcache_lock(cache, st);
+
+    if ((slot = mp_shmcache_find(cache, st, hash, key, klen))) {
+        mp_shmcache_item_t *item =
+            (mp_shmcache_item_t *)MP_SHMCACHE_AT(cache, *slot);
+        if (!mp_shmcache_expired(item, apr_time_now())) {
+            rv = APR_SUCCESS;
+        }
+        mp_shmcache_free(cache, st, item);
+    }
+
+    mp_shmcache_unlock(cache, st);
+
+    return rv;
+}
+
+void modperl_apr_shmcache_stats(modperl_apr_shmcache_t *cache,
+                                modperl_apr_shmcache_stats_t *stats)
+{
+    apr_uint32_t i;
+
+    memset(stats, 0, sizeof(*stats));
+
+    for (i = 0; i < cache->header->nstripes; i++) {
+        mp_shmcache_stripe_t *st = &cache->stripes[i];
+
+        mp_shmcache_lock(cache, st);
+        stats->hits      += st->stats.hits;
+        stats->misses    += st->stats.misses;
+        stats->sets      += st->stats.sets;
+        stats->evictions += st->stats.evictions;
+        stats->expired   += st->stats.expired;
+        stats->items     += st->stats.items;
+        mp_shmcache_unlock(cache, st);
+    }
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,86 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODPERL_APR_SHMCACHE_H
+#define MODPERL_APR_SHMCACHE_H
+
+#include "apr_shm.h"
+#include "apr_errno.h"
+
+/*
+ * a key/value cache in a shared memory segment, so the processes
+ * forked after its creation (e.g. the prefork children) share one
+ * copy of it instead of caching the same data in each interpreter
+ */
+typedef struct modperl_apr_shmcache_t modperl_apr_shmcache_t;
+
+/* called with the value while the entry is locked, to copy it out */
+typedef void (*modperl_apr_shmcache_copy_t)(void *data,
+                                            const char *val,
+                                            apr_size_t vlen);
+
+typedef struct {
+    apr_uint64_t hits;
+    apr_uint64_t misses;
+    apr_uint64_t sets;
+    apr_uint64_t evictions;
+    apr_uint64_t expired;
+    apr_uint32_t items;
+} modperl_apr_shmcache_stats_t;
+
+#ifndef MP_SOURCE_SCAN
+
+/* size is the size of the segment, which is split into stripes
+ * locked separately, each with its own pages of page_size bytes and
+ * its own APR proc mutex.  with file == NULL the segment is anonymous */
+apr_status_t modperl_apr_shmcache_create(modperl_apr_shmcache_t **cache,
+                                         apr_size_t size,
+                                         int stripes,
+                                         apr_size_t page_size,
+                                         const char *file,
+                                         apr_pool_t *p);
+
+/* APR_NOTFOUND if the key isn't there (or has expired) */
+apr_status_t modperl_apr_shmcache_get(modperl_apr_shmcache_t *cache,
+                                      const char *key, apr_size_t klen,
+                                      modperl_apr_shmcache_copy_t copy,
+                                      void *data, apr_uint64_t *cas);
+
+/* with cas != 0 the value is stored only if the entry is still the
+ * one with that cas token: APR_NOTFOUND if it is gone, APR_EEXIST if
+ * it was changed.  APR_ENOSPC if the entry is larger than a page.
+ * ttl is in seconds, 0 for no expiry */
+apr_status_t modperl_apr_shmcache_set(modperl_apr_shmcache_t *cache,
+                                      const char *key, apr_size_t klen,
+                                      const char *val, apr_size_t vlen,
+                                      apr_uint32_t ttl, apr_uint64_t cas);
+
+apr_status_t modperl_apr_shmcache_delete(modperl_apr_shmcache_t *cache,
+                                         const char *key, apr_size_t klen);
+
+void modperl_apr_shmcache_stats(modperl_apr_shmcache_t *cache,
+                                modperl_apr_shmcache_stats_t *stats);
+
+#endif /* MP_SOURCE_SCAN */
+
+#endif /* MODPERL_APR_SHMCACHE_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -43,6 +43,143 @@ static MP_INLINE SV *mpxs_APR__Table_overlay(pTHX_ apr_table_t *base,
 }
 
 
+/* Bulk export/import: cross the XS boundary once, instead of going
+ * through the tie interface for each key */
+
+/* key => value hash, the first value wins for multi-valued keys (as
+ * with get() in the scalar context). table keys are case-insensitive,
+ * the key is spelled as in the first entry */
+static MP_INLINE SV *mpxs_APR__Table_to_hash(pTHX_ apr_table_t *t)
+{
+    const apr_array_header_t *arr = apr_table_elts(t);
+    apr_table_entry_t *elts = (apr_table_entry_t *)arr->elts;
+    HV *hv = newHV();
+    HV *seen = (HV *)sv_2mortal((SV *)newHV()); /* the lowercased keys */
+    SV *fold = sv_2mortal(newSV(64));
+    int i;
+
+    if (arr->nelts) {
+        hv_ksplit(hv, arr->nelts);
+    }
+
+    for (i = 0; i < arr->nelts; i++) {
+        I32 len, j;
+        char *lc;
+
+        if (!elts[i].key) {
+            continue;
+        }
+
+        len = strlen(elts[i].key);
+        lc = SvGROW(fold, len + 1);
+        for (j = 0; j < len; j++) {
+            lc[j] = toLOWER(elts[i].key[j]);
+        }
+
+        if (!hv_exists(seen, lc, len)) {
+            (void)hv_store(seen, lc, len,
+                           SvREFCNT_inc_simple_NN(&PL_sv_yes), 0);
+            (void)hv_store(hv, elts[i].key, len,
+                           newSVpv(elts[i].val ? elts[i].val : "", 0), 0);
+        }
+    }
+
+    return newRV_noinc((SV *)hv);
+}
+
+/* [key1 => val1, key2 => val2, ...] in the table's order, preserving
+ * the duplicates */
+static MP_INLINE SV *mpxs_APR__Table_to_pairs(pTHX_ apr_table_t *t)
+{
+    const apr_array_header_t *arr = apr_table_elts(t);
+    apr_table_entry_t *elts = (apr_table_entry_t *)arr->elts;
+    AV *av = newAV();
+    int i;
+
+    if (arr->nelts) {
+        av_extend(av, 2 * arr->nelts - 1);
+    }
+
+    for (i = 0; i < arr->nelts; i++) {
+        if (!elts[i].key) {
+            continue;
+        }
+        av_push(av, newSVpv(elts[i].key, 0));
+        av_push(av, newSVpv(elts[i].val ? elts[i].val : "", 0));
+    }
+
+    return newRV_noinc((SV *)av);
+}
+
+/* set each key of the hash, an array reference value sets all its
+ * values and an undef value unsets the key. keys which aren't in the
+ * hash are left untouched */
+static MP_INLINE void mpxs_APR__Table_merge_from_hash(pTHX_ apr_table_t *t,
+                                                      SV *hv_sv)
+{
+    HV *hv;
+    HE *he;
+
+    if (!(SvROK(hv_sv) && SvTYPE(SvRV(hv_sv)) == SVt_PVHV)) {
+        Perl_croak(aTHX_ "Usage: $table->merge_from_hash(\\%%hash)");
+    }
+
+    hv = (HV *)SvRV(hv_sv);
+    hv_iterinit(hv);
+    while ((he = hv_iternext(hv))) {
+        I32 klen;
+        const char *key = hv_iterkey(he, &klen);
+        SV *val = hv_iterval(hv, he);
+
+        if (SvROK(val) && SvTYPE(SvRV(val)) == SVt_PVAV) {
+            AV *av = (AV *)SvRV(val);
+            I32 i;
+
+            apr_table_unset(t, key);
+            for (i = 0; i <= AvFILL(av); i++) {
+                SV **svp = av_fetch(av, i, FALSE);
+                if (svp && SvOK(*svp)) {
+                    apr_table_add(t, key, SvPV_nolen(*svp));
+                }
+            }
+        }
+        else if (SvOK(val)) {
+            apr_table_set(t, key, SvPV_nolen(val));
+        }
+        else {
+            apr_table_unset(t, key);
+        }
+    }
+}
+
+/* add all the key/value pairs of the array, e.g. the one returned by
+ * to_pairs() */
+static MP_INLINE void mpxs_APR__Table_add_pairs(pTHX_ apr_table_t *t,
+                                                SV *av_sv)
+{
+    AV *av;
+    I32 i;
+
+    if (!(SvROK(av_sv) && SvTYPE(SvRV(av_sv)) == SVt_PVAV)) {
+        Perl_croak(aTHX_ "Usage: $table->add_pairs(\\@pairs)");
+    }
+
+    av = (AV *)SvRV(av_sv);
+    if (AvFILL(av) % 2 == 0) {
+        Perl_croak(aTHX_ "$table->add_pairs: odd number of elements");
+    }
+
+    for (i = 0; i < AvFILL(av); i += 2) {
+        SV **key = av_fetch(av, i, FALSE);
+        SV **val = av_fetch(av, i + 1, FALSE);
+
+        if (key && val && SvOK(*key) && SvOK(*val)) {
+            apr_table_add(t, SvPV_nolen(*key), SvPV_nolen(*val));
+        }
+    }
+}
+
+
 typedef struct {
     SV *cv;
     apr_hash_t *filter;
@@ -132,11 +269,6 @@ int mpxs_apr_table_do(pTHX_ I32 items, SV **MARK, SV **SP)
     return 1;
 }
 
-static MP_INLINE int mpxs_APR__Table_EXISTS(apr_table_t *t, const char *key)
-{
-    return (NULL == apr_table_get(t, key)) ? 0 : 1;
-}
-
 /* Note: SvCUR is used as the iterator state counter, why not ;-? */
 #define mpxs_apr_table_iterix(sv) \
 SvCUR(SvRV(sv))
@@ -173,6 +305,201 @@ static MP_INLINE const char *mpxs_APR__Table_NEXTKEY(pTHX_ SV *tsv, SV *key)
     return NULL;
 }
 
+/* Tied access to big tables (e.g. hundreds of notes) in a loop is
+ * O(n^2) with apr_table_get, so once more than one lookup was done
+ * in a table of at least MPXS_TABLE_INDEX_MIN entries, we build a
+ * side index: lowercased key => index of the first entry with that
+ * key.  The index belongs to the apr_table_t, not to the tied object:
+ * $r->headers_in and friends return a new tied object on every call.
+ * It is kept in the interpreter (PL_modglobal), which has
+ * MPXS_TABLE_INDEX_SLOTS of them for the tables used last, and never
+ * written into the table's pool, which may be shared by all threads
+ * (e.g. the dir_config table of a server).  apr tables have no
+ * generation counter and can be modified by C code behind our back,
+ * so the index is rebuilt whenever the elts array, the number of
+ * entries or the first/last key pointers have changed, and hits are
+ * verified against the entry's key.
+ */
+#define MPXS_TABLE_INDEX_MIN 32
+
+#define MPXS_TABLE_INDEX_SLOTS 4
+
+/* longer keys are looked up with apr_table_get */
+#define MPXS_TABLE_INDEX_KEYLEN 256
+
+#define MPXS_TABLE_INDEX_KEY "APR::Table::index"
+
+typedef struct {
+    apr_table_t *t;
+    const void *elts;
+    int nelts;
+    const char *first;
+    const char *last;
+    int lookups;
+    UV used;
+} mpxs_table_index_t;
+
+/* the slots are an array of (state, index hash) pairs; the state
+ * lives in a PV so the whole array is cloned with the interpreter */
+static mpxs_table_index_t *mpxs_table_index_get(pTHX_ apr_table_t *t,
+                                                HV **index)
+{
+    SV **svp = hv_fetch(PL_modglobal, MPXS_TABLE_INDEX_KEY,
+                        MP_SSTRLEN(MPXS_TABLE_INDEX_KEY), TRUE);
+    mpxs_table_index_t *ti, *lru = NULL;
+    AV *slots;
+    UV used = 0;
+    int i, lru_i = 0;
+
+    if (!SvROK(*svp)) {
+        slots = newAV();
+        for (i = 0; i < MPXS_TABLE_INDEX_SLOTS; i++) {
+            SV *state = newSV(sizeof(*ti));
+            Zero(SvPVX(state), 1, mpxs_table_index_t);
+            SvCUR_set(state, sizeof(*ti));
+            SvPOK_on(state);
+            av_push(slots, state);
+            av_push(slots, newRV_noinc((SV *)newHV()));
+        }
+        sv_setsv(*svp, sv_2mortal(newRV_noinc((SV *)slots)));
+    }
+    slots = (AV *)SvRV(*svp);
+
+    for (i = 0; i < MPXS_TABLE_INDEX_SLOTS; i++) {
+        ti = (mpxs_table_index_t *)SvPVX(AvARRAY(slots)[i * 2]);
+        if (ti->used > used) {
+            used = ti->used;
+        }
+        if (ti->t == t) {
+            break;
+        }
+        if (!lru || ti->used < lru->used) {
+            lru = ti;
+            lru_i = i;
+        }
+    }
+
+    if (i == MPXS_TABLE_INDEX_SLOTS) {
+        /* reuse the least recently used slot */
+        i = lru_i;
+        ti = lru;
+        Zero(ti, 1, mpxs_table_index_t);
+        ti->t = t;
+        hv_clear((HV *)SvRV(AvARRAY(slots)[i * 2 + 1]));
+    }
+
+    ti->used = used + 1;
+    *index = (HV *)SvRV(AvARRAY(slots)[i * 2 + 1]);
+
+    return ti;
+}
+
+/* lowercase key into buf, NULL if it doesn't fit */
+static MP_INLINE const char *mpxs_table_index_fold(const char *key,
+                                                   char *buf,
+                                                   apr_size_t *len)
+{
+    char *d = buf;
+
+    for (*len = 0; *key; key++, (*len)++) {
+        if (*len == MPXS_TABLE_INDEX_KEYLEN - 1) {
+            return NULL;
+        }
+        *d++ = toLOWER(*key);
+    }
+    *d = '\0';
+
+    return buf;
+}
+
+static MP_INLINE int mpxs_table_index_is_stale(mpxs_table_index_t *ti,
+                                               const apr_array_header_t *arr)
+{
+    apr_table_entry_t *elts = (apr_table_entry_t *)arr->elts;
+
+    return !ti->elts || ti->elts != arr->elts || ti->nelts != arr->nelts ||
+        ti->first != elts[0].key || ti->last != elts[arr->nelts-1].key;
+}
+
+static void mpxs_table_index_build(pTHX_ mpxs_table_index_t *ti,
+                                   HV *index,
+                                   const apr_array_header_t *arr)
+{
+    apr_table_entry_t *elts = (apr_table_entry_t *)arr->elts;
+    int i;
+
+    hv_clear(index);
+
+    for (i = 0; i < arr->nelts; i++) {
+        char buf[MPXS_TABLE_INDEX_KEYLEN];
+        const char *key;
+        apr_size_t len;
+
+        if (!elts[i].key ||
+            !(key = mpxs_table_index_fold(elts[i].key, buf, &len))) {
+            continue;
+        }
+
+        /* apr_table_get returns the first entry with the given key */
+        if (!hv_exists(index, key, len)) {
+            (void)hv_store(index, key, len, newSViv(i), 0);
+        }
+    }
+
+    ti->lookups = 0;
+    ti->elts  = arr->elts;
+    ti->nelts = arr->nelts;
+    ti->first = elts[0].key;
+    ti->last  = elts[arr->nelts-1].key;
+}
+
+/* returns the value of key, using the index if the table is big
+ * enough, apr_table_get otherwise
+ */
+static const char *mpxs_table_index_get_val(pTHX_ apr_table_t *t,
+                                            const char *key)
+{
+    const apr_array_header_t *arr = apr_table_elts(t);
+    apr_table_entry_t *elts = (apr_table_entry_t *)arr->elts;
+    mpxs_table_index_t *ti;
+    HV *index;
+    char buf[MPXS_TABLE_INDEX_KEYLEN];
+    const char *fkey;
+    apr_size_t len;
+    SV **svp;
+
+    if (arr->nelts < MPXS_TABLE_INDEX_MIN ||
+        !(fkey = mpxs_table_index_fold(key, buf, &len))) {
+        return apr_table_get(t, key);
+    }
+
+    ti = mpxs_table_index_get(aTHX_ t, &index);
+
+    if (mpxs_table_index_is_stale(ti, arr)) {
+        /* one lookup is cheaper without the index, and a table
+         * modified between every lookup isn't worth indexing */
+        if (++ti->lookups < 2) {
+            return apr_table_get(t, key);
+        }
+        mpxs_table_index_build(aTHX_ ti, index, arr);
+    }
+
+    if (!(svp = hv_fetch(index, fkey, len, FALSE))) {
+        return NULL;
+    }
+    else {
+        const int i = (int)SvIVX(*svp);
+        if (i < arr->nelts && elts[i].key && !strcasecmp(key, elts[i].key)) {
+            return elts[i].val;
+        }
+    }
+
+    /* the table was reordered in place (e.g. apr_table_compress) */
+    mpxs_table_index_build(aTHX_ ti, index, arr);
+
+    return apr_table_get(t, key);
+}
+
 /* Try to shortcut apr_table_get by fetching the key using the current
  * iterator (unless it's inactive or points at different key).
  */
@@ -189,10 +516,17 @@ static MP_INLINE const char *mpxs_APR__Table_FETCH(pTHX_ SV *tsv,
         return elts[i-1].val;
     }
     else {
-        return apr_table_get(t, key);
+        return mpxs_table_index_get_val(aTHX_ t, key);
     }
 }
 
+static MP_INLINE int mpxs_APR__Table_EXISTS(pTHX_ SV *tsv, const char *key)
+{
+    SV* rv = modperl_hash_tied_object_rv(aTHX_ "APR::Table", tsv);
+    apr_table_t *t = INT2PTR(apr_table_t *, SvIVX(SvRV(rv)));
+
+    return (NULL == mpxs_table_index_get_val(aTHX_ t, key)) ? 0 : 1;
+}
 
 MP_STATIC XS(MPXS_apr_table_get)
 {
@@ -26,6 +26,22 @@ static void mpxs_Apache2__Log_BOOT(pTHX)
     Perl_croak(aTHX_ "Argument is not an Apache2::RequestRec "   \
                "or Apache2::ServerRec object")
 
+/* the server (and the request, if any) an Apache2::Log object logs to */
+static server_rec *mpxs_Apache2__Log_server(pTHX_ SV *sv, request_rec **rp)
+{
+    *rp = NULL;
+
+    if (SvROK(sv) && sv_isa(sv, "Apache2::Log::Request")) {
+        *rp = INT2PTR(request_rec *, SvObjIV(sv));
+        return (*rp)->server;
+    }
+    else if (SvROK(sv) && sv_isa(sv, "Apache2::Log::Server")) {
+        return INT2PTR(server_rec *, SvObjIV(sv));
+    }
+
+    return modperl_global_get_server_rec();
+}
+
 static void mpxs_ap_log_error(pTHX_ int level, SV *sv, SV *msg)
 {
     char *file = NULL;
@@ -34,28 +50,17 @@ static void mpxs_ap_log_error(pTHX_ int level, SV *sv, SV *msg)
     SV *svstr = (SV *)NULL;
     STRLEN n_a;
     int lmask = level & APLOG_LEVELMASK;
-    server_rec *s;
-    request_rec *r = NULL;
-
-    if (SvROK(sv) && sv_isa(sv, "Apache2::Log::Request")) {
-        r = INT2PTR(request_rec *, SvObjIV(sv));
-        s = r->server;
-    }
-    else if (SvROK(sv) && sv_isa(sv, "Apache2::Log::Server")) {
-        s = INT2PTR(server_rec *, SvObjIV(sv));
-    }
-    else {
-        s = modperl_global_get_server_rec();
-    }
+    request_rec *r;
+    server_rec *s = mpxs_Apache2__Log_server(aTHX_ sv, &r);
+    int enabled = modperl_log_is_level(s, r, level);
 
-    if ((lmask >= APLOG_DEBUG) && (mp_loglevel(s) >= APLOG_DEBUG)) {
+    if ((lmask >= APLOG_DEBUG) && enabled) {
         COP *cop = PL_curcop;
         file = CopFILE(cop); /* (caller)[1] */
         line = CopLINE(cop); /* (caller)[2] */
     }
 
-    if ((mp_loglevel(s) >= lmask) &&
-        SvROK(msg) && (SvTYPE(SvRV(msg)) == SVt_PVCV)) {
+    if (enabled && SvROK(msg) && (SvTYPE(SvRV(msg)) == SVt_PVCV)) {
         dSP;
         ENTER;SAVETMPS;
         PUSHMARK(sp);
@@ -71,7 +76,10 @@ static void mpxs_ap_log_error(pTHX_ int level, SV *sv, SV *msg)
         str = SvPV(msg,n_a);
     }
 
-    if (r) {
+    if (enabled && modperl_log_async(s, r, file, line, level, str)) {
+        /* queued for the PerlLogAsync writer */
+    }
+    else if (r) {
         ap_log_rerror(file, line, mp_module_index_ level, 0, r,
 		      "%s", str);
     }
@@ -119,6 +127,59 @@ static SV *mpxs_Apache2__Log_log(pTHX_ SV *sv, int logtype)
 #define mpxs_Apache2__ServerRec_log(sv)                  \
     mpxs_Apache2__Log_log(aTHX_ sv, MP_LOG_SERVER)
 
+#define mpxs_Apache2__Log_async_stats()                  \
+    modperl_log_async_stats(aTHX)
+
+#define mpxs_Apache2__Log_async_flush()                  \
+    modperl_log_async_flush()
+
+#define mpxs_Apache2__Log_request(sv, r)                                \
+    if (!(SvROK(sv) && sv_isa(sv, "Apache2::Log::Request"))) {          \
+        Perl_croak(aTHX_ "log fields require an Apache2::Log::Request " \
+                   "object ($r->log)");                                 \
+    }                                                                   \
+    r = INT2PTR(request_rec *, SvObjIV(sv))
+
+/* $r->log->field(key => $val, ...) */
+MP_STATIC XS(MPXS_Apache2__Log_field)
+{
+    dXSARGS;
+    request_rec *r;
+    I32 i;
+
+    if (items < 3 || !(items % 2)) {
+        Perl_croak(aTHX_ "usage: $r->log->field(key => $val, ...)");
+    }
+
+    mpxs_Apache2__Log_request(ST(0), r);
+
+    for (i = 1; i < items; i += 2) {
+        modperl_log_field_set(aTHX_ r, SvPV_nolen(ST(i)), ST(i+1));
+    }
+
+    XSRETURN_EMPTY;
+}
+
+/* the JSON object which will be logged, undef if no fields were set */
+static MP_INLINE SV *mpxs_Apache2__Log_fields_json(pTHX_ SV *sv)
+{
+    request_rec *r;
+    const char *json;
+
+    mpxs_Apache2__Log_request(sv, r);
+    json = modperl_log_fields_json(r);
+
+    return json ? newSVpv(json, 0) : &PL_sv_undef;
+}
+
+static MP_INLINE int mpxs_Apache2__Log_is_enabled(pTHX_ SV *sv, int level)
+{
+    request_rec *r;
+    server_rec *s = mpxs_Apache2__Log_server(aTHX_ sv, &r);
+
+    return modperl_log_is_level(s, r, level);
+}
+
 static MP_INLINE SV *modperl_perl_do_join(pTHX_ SV **mark, SV **sp)
 {
     SV *sv = newSV(0);
@@ -152,14 +213,6 @@ MP_STATIC XS(MPXS_Apache2__Log_dispatch)
                    mpxs_cv_name());
     }
 
-    if (items > 2) {
-        msgsv = my_do_join(MARK+1, SP);
-    }
-    else {
-        msgsv = ST(1);
-        (void)SvREFCNT_inc(msgsv);
-    }
-
     switch (*name) {
       case 'e':
         if (*(name + 1) == 'r') {
@@ -191,6 +244,41 @@ MP_STATIC XS(MPXS_Apache2__Log_dispatch)
         break;
     };
 
+    /* don't build the message for a disabled level */
+    {
+        request_rec *r;
+        server_rec *s = mpxs_Apache2__Log_server(aTHX_ ST(0), &r);
+        if (!modperl_log_is_level(s, r, level)) {
+            XSRETURN_EMPTY;
+        }
+    }
+
+    if (items > 2 && SvROK(ST(1)) && SvTYPE(SvRV(ST(1))) == SVt_PVCV) {
+        /* $log->debug(sub {...}, @args) */
+        SV *code = ST(1);
+        I32 i;
+
+        ENTER;SAVETMPS;
+        PUSHMARK(SP);
+        EXTEND(SP, items - 2);
+        for (i = 2; i < items; i++) {
+            PUSHs(ST(i));
+        }
+        PUTBACK;
+        (void)call_sv(code, G_SCALAR);
+        SPAGAIN;
+        msgsv = newSVsv(POPs);
+        PUTBACK;
+        FREETMPS;LEAVE;
+    }
+    else if (items > 2) {
+        msgsv = my_do_join(MARK+1, SP);
+    }
+    else {
+        msgsv = ST(1);
+        (void)SvREFCNT_inc(msgsv);
+    }
+
     mpxs_ap_log_error(aTHX_ level, ST(0), msgsv);
 
     SvREFCNT_dec(msgsv);
@@ -16,6 +16,9 @@
 
 #define mpxs_Apache2__Module_top_module() ap_top_module
 
+#define mpxs_Apache2__Module_merge_stats() \
+    modperl_module_merge_stats(aTHX)
+
 static MP_INLINE int mpxs_Apache2__Module_loaded(pTHX_ char *name)
 {
     char nameptr[256];
@@ -39,6 +39,27 @@ static MP_INLINE void mpxs_ModPerl__Util_untaint(pTHX_ I32 items,
 #define mpxs_ModPerl__Util_unload_package_xs(pkg) \
     modperl_package_unload(aTHX_ pkg)
 
+#define mpxs_ModPerl__Util_unload_package_tree(pkg) \
+    modperl_package_unload_tree(aTHX_ pkg)
+
+#define mpxs_ModPerl__Util_unload_package_stats() \
+    modperl_package_unload_stats(aTHX)
+
+#define mpxs_ModPerl__Util_handlers_profile() \
+    modperl_profile_as_hvrv(aTHX)
+
+#define mpxs_ModPerl__Util_handlers_profile_reset() \
+    modperl_profile_reset()
+
+#define mpxs_ModPerl__Util_timelines() \
+    modperl_timeline_as_avrv(aTHX)
+
+#define mpxs_ModPerl__Util_request_arena_stats() \
+    modperl_arena_stats(aTHX)
+
+#define mpxs_ModPerl__Util_enable_virtual_cwd() \
+    modperl_perl_pp_vcwd_set(aTHX)
+
 /* ModPerl::Util::exit lives in mod_perl.so, see modperl_perl.c */
 
 /*
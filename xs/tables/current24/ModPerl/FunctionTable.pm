@@ -31,6 +31,116 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'AV *',
+    'name' => 'modperl_arena_av',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_arena_av_release',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'AV *',
+        'name' => 'av'
+      }
+    ]
+  },
+  {
+    'return_type' => 'HV *',
+    'name' => 'modperl_arena_hv',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_arena_hv_release',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'HV *',
+        'name' => 'hv'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_arena_init',
+    'args' => [
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      }
+    ]
+  },
+  {
+    'return_type' => 'SV *',
+    'name' => 'modperl_arena_ptr2obj',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'char *',
+        'name' => 'classname'
+      },
+      {
+        'type' => 'void *',
+        'name' => 'ptr'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_arena_request_done',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'request_rec *',
+        'name' => 'r'
+      }
+    ]
+  },
+  {
+    'return_type' => 'const char *',
+    'name' => 'modperl_arena_size_set',
+    'args' => [
+      {
+        'type' => 'const char *',
+        'name' => 'arg'
+      }
+    ]
+  },
+  {
+    'return_type' => 'SV *',
+    'name' => 'modperl_arena_stats',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
   {
     'return_type' => 'int',
     'name' => 'modperl_authen_handler',
@@ -752,6 +862,24 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'const char *',
+    'name' => 'modperl_cmd_log_async',
+    'args' => [
+      {
+        'type' => 'cmd_parms *',
+        'name' => 'parms'
+      },
+      {
+        'type' => 'void *',
+        'name' => 'mconfig'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'arg'
+      }
+    ]
+  },
   {
     'return_type' => 'const char *',
     'name' => 'modperl_cmd_log_handlers',
@@ -1210,6 +1338,24 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'const char *',
+    'name' => 'modperl_cmd_timeline_sample',
+    'args' => [
+      {
+        'type' => 'cmd_parms *',
+        'name' => 'parms'
+      },
+      {
+        'type' => 'void *',
+        'name' => 'mconfig'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'arg'
+      }
+    ]
+  },
   {
     'return_type' => 'const char *',
     'name' => 'modperl_cmd_trace',
@@ -3490,6 +3636,20 @@ $ModPerl::FunctionTable = [
     'name' => 'modperl_is_running',
     'args' => []
   },
+  {
+    'return_type' => 'const char *',
+    'name' => 'modperl_json_str',
+    'args' => [
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'str'
+      }
+    ]
+  },
   {
     'return_type' => 'modperl_list_t *',
     'name' => 'modperl_list_append',
@@ -3577,131 +3737,270 @@ $ModPerl::FunctionTable = [
   },
   {
     'return_type' => 'int',
-    'name' => 'modperl_log_handler',
+    'name' => 'modperl_log_async',
     'args' => [
       {
-        'type' => 'request_rec *',
-        'name' => 'r'
-      }
-    ]
-  },
-  {
-    'return_type' => 'int',
-    'name' => 'modperl_map_to_storage_handler',
-    'args' => [
+        'type' => 'server_rec *',
+        'name' => 's'
+      },
       {
         'type' => 'request_rec *',
         'name' => 'r'
-      }
-    ]
-  },
-  {
-    'return_type' => 'void',
-    'name' => 'modperl_mgv_append',
-    'args' => [
+      },
       {
-        'type' => 'PerlInterpreter*',
-        'name' => 'my_perl'
+        'type' => 'const char *',
+        'name' => 'file'
       },
       {
-        'type' => 'apr_pool_t *',
-        'name' => 'p'
+        'type' => 'int',
+        'name' => 'line'
       },
       {
-        'type' => 'modperl_mgv_t *',
-        'name' => 'symbol'
+        'type' => 'int',
+        'name' => 'level'
       },
       {
         'type' => 'const char *',
-        'name' => 'name'
+        'name' => 'msg'
       }
     ]
   },
   {
-    'return_type' => 'char *',
-    'name' => 'modperl_mgv_as_string',
+    'return_type' => 'void',
+    'name' => 'modperl_log_async_child_init',
     'args' => [
-      {
-        'type' => 'PerlInterpreter*',
-        'name' => 'my_perl'
-      },
-      {
-        'type' => 'modperl_mgv_t *',
-        'name' => 'symbol'
-      },
       {
         'type' => 'apr_pool_t *',
         'name' => 'p'
       },
       {
-        'type' => 'int',
-        'name' => 'package'
+        'type' => 'server_rec *',
+        'name' => 's'
       }
     ]
   },
   {
-    'return_type' => 'modperl_mgv_t *',
-    'name' => 'modperl_mgv_compile',
+    'return_type' => 'void',
+    'name' => 'modperl_log_async_flush',
+    'args' => []
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_log_async_init',
     'args' => [
-      {
-        'type' => 'PerlInterpreter*',
-        'name' => 'my_perl'
-      },
       {
         'type' => 'apr_pool_t *',
         'name' => 'p'
-      },
+      }
+    ]
+  },
+  {
+    'return_type' => 'const char *',
+    'name' => 'modperl_log_async_size_set',
+    'args' => [
       {
         'type' => 'const char *',
-        'name' => 'name'
+        'name' => 'arg'
       }
     ]
   },
   {
-    'return_type' => 'int',
-    'name' => 'modperl_mgv_equal',
+    'return_type' => 'SV *',
+    'name' => 'modperl_log_async_stats',
     'args' => [
       {
-        'type' => 'modperl_mgv_t *',
-        'name' => 'mgv1'
-      },
-      {
-        'type' => 'modperl_mgv_t *',
-        'name' => 'mgv2'
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
       }
     ]
   },
   {
     'return_type' => 'void',
-    'name' => 'modperl_mgv_hash_handlers',
+    'name' => 'modperl_log_field_set',
     'args' => [
       {
-        'type' => 'apr_pool_t *',
-        'name' => 'p'
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
       },
       {
-        'type' => 'server_rec *',
-        'name' => 's'
+        'type' => 'request_rec *',
+        'name' => 'r'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'key'
+      },
+      {
+        'type' => 'SV *',
+        'name' => 'sv'
       }
     ]
   },
   {
-    'return_type' => 'modperl_mgv_t *',
-    'name' => 'modperl_mgv_last',
+    'return_type' => 'int',
+    'name' => 'modperl_log_fields_emit',
     'args' => [
       {
-        'type' => 'modperl_mgv_t *',
-        'name' => 'symbol'
+        'type' => 'request_rec *',
+        'name' => 'r'
       }
     ]
   },
   {
-    'return_type' => 'char *',
-    'name' => 'modperl_mgv_last_name',
+    'return_type' => 'const char *',
+    'name' => 'modperl_log_fields_json',
     'args' => [
       {
-        'type' => 'modperl_mgv_t *',
-        'name' => 'symbol'
+        'type' => 'request_rec *',
+        'name' => 'r'
+      }
+    ]
+  },
+  {
+    'return_type' => 'int',
+    'name' => 'modperl_log_handler',
+    'args' => [
+      {
+        'type' => 'request_rec *',
+        'name' => 'r'
+      }
+    ]
+  },
+  {
+    'return_type' => 'int',
+    'name' => 'modperl_log_is_level',
+    'args' => [
+      {
+        'type' => 'server_rec *',
+        'name' => 's'
+      },
+      {
+        'type' => 'request_rec *',
+        'name' => 'r'
+      },
+      {
+        'type' => 'int',
+        'name' => 'level'
+      }
+    ]
+  },
+  {
+    'return_type' => 'int',
+    'name' => 'modperl_map_to_storage_handler',
+    'args' => [
+      {
+        'type' => 'request_rec *',
+        'name' => 'r'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_mgv_append',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter*',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      },
+      {
+        'type' => 'modperl_mgv_t *',
+        'name' => 'symbol'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'name'
+      }
+    ]
+  },
+  {
+    'return_type' => 'char *',
+    'name' => 'modperl_mgv_as_string',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter*',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'modperl_mgv_t *',
+        'name' => 'symbol'
+      },
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      },
+      {
+        'type' => 'int',
+        'name' => 'package'
+      }
+    ]
+  },
+  {
+    'return_type' => 'modperl_mgv_t *',
+    'name' => 'modperl_mgv_compile',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter*',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'name'
+      }
+    ]
+  },
+  {
+    'return_type' => 'int',
+    'name' => 'modperl_mgv_equal',
+    'args' => [
+      {
+        'type' => 'modperl_mgv_t *',
+        'name' => 'mgv1'
+      },
+      {
+        'type' => 'modperl_mgv_t *',
+        'name' => 'mgv2'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_mgv_hash_handlers',
+    'args' => [
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      },
+      {
+        'type' => 'server_rec *',
+        'name' => 's'
+      }
+    ]
+  },
+  {
+    'return_type' => 'modperl_mgv_t *',
+    'name' => 'modperl_mgv_last',
+    'args' => [
+      {
+        'type' => 'modperl_mgv_t *',
+        'name' => 'symbol'
+      }
+    ]
+  },
+  {
+    'return_type' => 'char *',
+    'name' => 'modperl_mgv_last_name',
+    'args' => [
+      {
+        'type' => 'modperl_mgv_t *',
+        'name' => 'symbol'
       }
     ]
   },
@@ -3895,6 +4194,26 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_module_merge_cache_init',
+    'args' => [
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      }
+    ]
+  },
+  {
+    'return_type' => 'SV *',
+    'name' => 'modperl_module_merge_stats',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
   {
     'return_type' => 'SV *',
     'name' => 'modperl_newSVsv_obj',
@@ -4099,6 +4418,40 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_package_unload_init',
+    'args' => [
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      }
+    ]
+  },
+  {
+    'return_type' => 'SV *',
+    'name' => 'modperl_package_unload_stats',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_package_unload_tree',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'package'
+      }
+    ]
+  },
   {
     'return_type' => 'void',
     'name' => 'modperl_perl_av_push_elts_ref',
@@ -4422,6 +4775,16 @@ $ModPerl::FunctionTable = [
     'name' => 'modperl_perl_pp_unset_all',
     'args' => []
   },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_perl_pp_vcwd_set',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
   {
     'return_type' => 'SV *',
     'name' => 'modperl_perl_sv_setref_uv',
@@ -4548,6 +4911,62 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'SV *',
+    'name' => 'modperl_profile_as_hvrv',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
+  {
+    'return_type' => 'apr_interval_time_t',
+    'name' => 'modperl_profile_cpu_now',
+    'args' => []
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_profile_init',
+    'args' => [
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_profile_record',
+    'args' => [
+      {
+        'type' => 'const char *',
+        'name' => 'name'
+      },
+      {
+        'type' => 'modperl_times_t *',
+        'name' => 'start'
+      },
+      {
+        'type' => 'modperl_times_t *',
+        'name' => 'end'
+      },
+      {
+        'type' => 'int',
+        'name' => 'status'
+      },
+      {
+        'type' => 'int',
+        'name' => 'failed'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_profile_reset',
+    'args' => []
+  },
   {
     'return_type' => 'SV *',
     'name' => 'modperl_ptr2obj',
@@ -5160,6 +5579,72 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_timeline_add',
+    'args' => [
+      {
+        'type' => 'request_rec *',
+        'name' => 'r'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'what'
+      },
+      {
+        'type' => 'const char *',
+        'name' => 'name'
+      },
+      {
+        'type' => 'apr_time_t',
+        'name' => 'start'
+      }
+    ]
+  },
+  {
+    'return_type' => 'SV *',
+    'name' => 'modperl_timeline_as_avrv',
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_timeline_init',
+    'args' => [
+      {
+        'type' => 'apr_pool_t *',
+        'name' => 'p'
+      }
+    ]
+  },
+  {
+    'return_type' => 'apr_time_t',
+    'name' => 'modperl_timeline_now',
+    'args' => [
+      {
+        'type' => 'request_rec *',
+        'name' => 'r'
+      }
+    ]
+  },
+  {
+    'return_type' => 'void',
+    'name' => 'modperl_timeline_sample',
+    'args' => [
+      {
+        'type' => 'request_rec *',
+        'name' => 'r'
+      },
+      {
+        'type' => 'modperl_config_req_t *',
+        'name' => 'rcfg'
+      }
+    ]
+  },
   {
     'return_type' => 'void',
     'name' => 'modperl_tipool_add',
@@ -6114,8 +6599,12 @@ $ModPerl::FunctionTable = [
     ],
     'args' => [
       {
-        'type' => 'apr_table_t *',
-        'name' => 't'
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'SV *',
+        'name' => 'tsv'
       },
       {
         'type' => 'const char *',
@@ -6167,6 +6656,28 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'void',
+    'name' => 'mpxs_APR__Table_add_pairs',
+    'attr' => [
+      'static',
+      '__inline__'
+    ],
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'apr_table_t *',
+        'name' => 't'
+      },
+      {
+        'type' => 'SV *',
+        'name' => 'av_sv'
+      }
+    ]
+  },
   {
     'return_type' => 'SV *',
     'name' => 'mpxs_APR__Table_copy',
@@ -6211,6 +6722,28 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'void',
+    'name' => 'mpxs_APR__Table_merge_from_hash',
+    'attr' => [
+      'static',
+      '__inline__'
+    ],
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'apr_table_t *',
+        'name' => 't'
+      },
+      {
+        'type' => 'SV *',
+        'name' => 'hv_sv'
+      }
+    ]
+  },
   {
     'return_type' => 'SV *',
     'name' => 'mpxs_APR__Table_overlay',
@@ -6237,6 +6770,42 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'SV *',
+    'name' => 'mpxs_APR__Table_to_hash',
+    'attr' => [
+      'static',
+      '__inline__'
+    ],
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'apr_table_t *',
+        'name' => 't'
+      }
+    ]
+  },
+  {
+    'return_type' => 'SV *',
+    'name' => 'mpxs_APR__Table_to_pairs',
+    'attr' => [
+      'static',
+      '__inline__'
+    ],
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'apr_table_t *',
+        'name' => 't'
+      }
+    ]
+  },
   {
     'return_type' => 'char *',
     'name' => 'mpxs_APR__URI_port',
@@ -6668,6 +7237,46 @@ $ModPerl::FunctionTable = [
       }
     ]
   },
+  {
+    'return_type' => 'SV *',
+    'name' => 'mpxs_Apache2__Log_fields_json',
+    'attr' => [
+      'static',
+      '__inline__'
+    ],
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'SV *',
+        'name' => 'sv'
+      }
+    ]
+  },
+  {
+    'return_type' => 'int',
+    'name' => 'mpxs_Apache2__Log_is_enabled',
+    'attr' => [
+      'static',
+      '__inline__'
+    ],
+    'args' => [
+      {
+        'type' => 'PerlInterpreter *',
+        'name' => 'my_perl'
+      },
+      {
+        'type' => 'SV *',
+        'name' => 'sv'
+      },
+      {
+        'type' => 'int',
+        'name' => 'level'
+      }
+    ]
+  },
   {
     'return_type' => 'SV *',
     'name' => 'mpxs_Apache2__Log_log',